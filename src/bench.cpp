@@ -0,0 +1,394 @@
+/**
+ * AtomicEngine 0.1 - Micro-benchmarks
+ *
+ * Build: cmake -DATOMICENGINE_BENCH=ON .. && make AtomicBench
+ * Run:   ./AtomicBench [benchmark] [args...]
+ *
+ *   weld [files.obj...]    std::unordered_map<Vertex> welding vs AtomicMesh::Welder (serial and parallel)
+ *   jobs [max threads]     AtomicJobs scaling from 1 to N threads: parallelFor and fine-grained spawn trees
+ *   jobs-stress [rounds]   AtomicJobs correctness: nested jobs, continuations and counters under contention
+ *   cull [boxes]           AtomicCull frustum culling: scalar vs SSE vs AVX vs parallel, boxes tested per ms
+ *   mips [size]            AtomicTexture sRGB mip chain: scalar vs SSE vs AVX2 vs parallel, source texels per ms
+ */
+
+#include <chrono>
+
+#include "core/AtomicEngine.h"
+
+typedef AtomicVK::Vertex Vertex;
+
+template<typename F> static double bestOf(int runs, F fn)
+{
+  double best = 1e30;
+  for (int i=0; i<runs; i++)
+  {
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+  }
+  return best;
+}
+
+static void benchWeld(std::vector<const char*> files)
+{
+  if (files.empty())
+    files = { "../textures/alduin.obj", "../textures/viking_room.obj", "../textures/teapot.obj" };
+
+  AtomicJobs jobs;
+
+  printf("%-30s %10s | %22s | %22s | %26s | %22s\n", "weld", "indices", "unordered_map ms (n)", "welder/bytes ms (n)", "welder/tuple+bytes ms (n)", "parallel ms (n)");
+
+  for (const char *file : files)
+  {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file))
+    {
+      printf("%-30s failed to load: %s\n", file, (warn + err).c_str());
+      continue;
+    }
+
+    size_t index_total = 0;
+    for (const auto& shape : shapes) index_total += shape.mesh.indices.size();
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    size_t unique_map = 0, unique_bytes = 0, unique_tuple = 0;
+
+    // Baseline: the loop initVulkan used to run (count + 2x operator[] on a node map)
+    double t_map = bestOf(5, [&]() {
+      vertices.clear(); indices.clear();
+      std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+
+      for (const auto& shape : shapes)
+        for (const auto& index : shape.mesh.indices)
+        {
+          Vertex vertex = AtomicVK::objVertex(attrib, {index.vertex_index, index.texcoord_index, index.normal_index});
+          if (uniqueVertices.count(vertex) == 0) {
+            uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(vertex);
+          }
+          indices.push_back(uniqueVertices[vertex]);
+        }
+
+      unique_map = vertices.size();
+    });
+
+    // Welder keyed on raw vertex bytes
+    double t_bytes = bestOf(5, [&]() {
+      indices.clear();
+      AtomicMesh::Welder<Vertex> welder(index_total);
+      indices.reserve(index_total);
+
+      for (const auto& shape : shapes)
+        for (const auto& index : shape.mesh.indices)
+          indices.push_back(welder.weld(AtomicVK::objVertex(attrib, {index.vertex_index, index.texcoord_index, index.normal_index})));
+
+      unique_bytes = welder.unique().size();
+    });
+
+    // Tuple welder, then byte welder over the unique tuples (what loadModel uses)
+    double t_tuple = bestOf(5, [&]() {
+      indices.clear();
+      AtomicMesh::Welder<AtomicMesh::ObjIndex> tuples(index_total);
+      indices.reserve(index_total);
+
+      for (const auto& shape : shapes)
+        for (const auto& index : shape.mesh.indices)
+          indices.push_back(tuples.weld({index.vertex_index, index.texcoord_index, index.normal_index}));
+
+      AtomicMesh::Welder<Vertex> unique(tuples.unique().size());
+      std::vector<uint32_t> remap(tuples.unique().size());
+      for (size_t i = 0; i < remap.size(); i++) remap[i] = unique.weld(AtomicVK::objVertex(attrib, tuples.unique()[i]));
+      for (auto& index : indices) index = remap[index];
+
+      unique_tuple = unique.unique().size();
+    });
+
+    // Same two-stage weld split across the job pool, merged in chunk order
+    size_t unique_parallel = 0;
+    double t_parallel = bestOf(5, [&]() {
+      std::vector<std::span<const tinyobj::index_t>> chunks;
+      for (const auto& shape : shapes)
+      {
+        std::span<const tinyobj::index_t> all(shape.mesh.indices);
+        for (size_t offset = 0; offset < all.size(); offset += MESH_WELD_CHUNK_MIN / 4)
+          chunks.push_back(all.subspan(offset, std::min<size_t>(MESH_WELD_CHUNK_MIN / 4, all.size() - offset)));
+      }
+
+      AtomicMesh::weldParallel(jobs, chunks, [&](const tinyobj::index_t &index) {
+        return AtomicVK::objVertex(attrib, {index.vertex_index, index.texcoord_index, index.normal_index});
+      }, vertices, indices);
+
+      unique_parallel = vertices.size();
+    });
+
+    printf("%-30s %10zu | %12.2f (%7zu) | %12.2f (%7zu) | %16.2f (%7zu) | %12.2f (%7zu)\n", file, index_total, t_map, unique_map, t_bytes, unique_bytes, t_tuple, unique_tuple, t_parallel, unique_parallel);
+  }
+}
+
+// Leaf work with no memory traffic, so scaling reflects the scheduler rather than bandwidth
+static uint64_t spin(uint64_t seed, unsigned rounds)
+{
+  for (unsigned i = 0; i < rounds; i++) seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+  return seed;
+}
+
+static void spawnTree(AtomicJobs &jobs, AtomicJobs::Counter &counter, std::atomic<uint64_t> &sum, unsigned depth)
+{
+  if (!depth)
+  {
+    sum.fetch_add(spin(depth, 2000) & 1, std::memory_order_relaxed);
+    return;
+  }
+
+  for (int child = 0; child < 4; child++)
+    jobs.run([&jobs, &counter, &sum, depth] { spawnTree(jobs, counter, sum, depth - 1); }, &counter);
+}
+
+static void benchJobs(std::vector<const char*> args)
+{
+  unsigned max_threads = args.empty() ? std::max(1u, std::thread::hardware_concurrency()) : (unsigned) atoi(args[0]);
+  const size_t items = 1 << 20;
+  std::vector<uint64_t> out(items);
+
+  printf("%-8s | %20s | %20s | %28s\n", "threads", "parallelFor ms", "speedup", "spawn tree (4^7 leaves) ms");
+
+  double base_for = 0, base_tree = 0;
+  for (unsigned threads = 1; threads <= max_threads; threads++)
+  {
+    AtomicJobs jobs(threads);
+
+    double t_for = bestOf(5, [&]() {
+      jobs.parallelFor(items, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) out[i] = spin(i, 64);
+      });
+    });
+
+    std::atomic<uint64_t> sum{0};
+    double t_tree = bestOf(5, [&]() {
+      AtomicJobs::Counter counter;
+      spawnTree(jobs, counter, sum, 7);
+      jobs.wait(counter);
+    });
+
+    if (threads == 1) base_for = t_for, base_tree = t_tree;
+    printf("%-8u | %20.2f | %19.2fx | %20.2f (%5.2fx)\n", threads, t_for, base_for / t_for, t_tree, base_tree / t_tree);
+  }
+}
+
+static void benchJobsStress(std::vector<const char*> args)
+{
+  unsigned rounds = args.empty() ? 200 : (unsigned) atoi(args[0]);
+  AtomicJobs jobs;
+  size_t failures = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (unsigned round = 0; round < rounds; round++)
+  {
+    // Nested spawns all land on one counter
+    std::atomic<uint32_t> count{0};
+    {
+      AtomicJobs::Counter counter;
+      std::function<void(unsigned)> tree = [&](unsigned depth) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        if (depth) for (int c = 0; c < 4; c++) jobs.run([&tree, depth] { tree(depth - 1); }, &counter);
+      };
+      jobs.run([&tree] { tree(5); }, &counter);
+      jobs.wait(counter);
+    }
+    if (count.load() != 1365) failures++;  // 4^0 + ... + 4^5
+
+    // Chain of continuations: each stage must observe every job of the stage before it
+    const int stages = 8, width = 64;
+    std::atomic<int> done[stages];
+    for (auto &d : done) d = 0;
+    std::atomic<int> order_errors{0};
+    {
+      std::vector<std::unique_ptr<AtomicJobs::Counter>> counters;
+      for (int s = 0; s < stages; s++) counters.push_back(std::make_unique<AtomicJobs::Counter>());
+
+      for (int w = 0; w < width; w++)
+        jobs.run([&] { done[0]++; }, counters[0].get());
+
+      for (int s = 1; s < stages; s++)
+        jobs.then(*counters[s - 1], [&, s] {
+          for (int w = 0; w < width; w++)
+            jobs.run([&, s] { if (done[s - 1].load() != width) order_errors++; done[s]++; }, counters[s].get());
+        }, counters[s].get());
+
+      jobs.wait(*counters[stages - 1]);
+    }
+    if (order_errors.load() || done[stages - 1].load() != width) failures++;
+
+    // parallelFor covers every index exactly once
+    std::vector<std::atomic<uint8_t>> hits(100003);
+    jobs.parallelFor(hits.size(), 97, [&](size_t begin, size_t end) { for (size_t i = begin; i < end; i++) hits[i]++; });
+    if (std::any_of(hits.begin(), hits.end(), [](const std::atomic<uint8_t> &h) { return h.load() != 1; })) failures++;
+
+    // Submissions trickle in while workers drain the counter to zero between them; wait() must still see every job,
+    // including the slow ones still running when it is called
+    std::atomic<uint32_t> ran{0};
+    {
+      AtomicJobs::Counter counter;
+      for (int j = 0; j < 64; j++)
+      {
+        jobs.run([&ran, j] {
+          if (j % 8 == 7) std::this_thread::sleep_for(std::chrono::microseconds(20));
+          ran.fetch_add(1, std::memory_order_relaxed);
+        }, &counter);
+        if (j & 1) std::this_thread::yield();
+      }
+      jobs.wait(counter);
+    }
+    if (ran.load() != 64) failures++;
+
+    // Same for parallelFor with one-item chunks: nothing may still run once it returns
+    ran = 0;
+    jobs.parallelFor(257, 1, [&ran](size_t begin, size_t end) { ran.fetch_add((uint32_t) (end - begin), std::memory_order_relaxed); });
+    if (ran.load() != 257) failures++;
+
+    // Throwing chunks (the caller's own first one included) still finish every chunk, then rethrow once
+    for (size_t thrower : {(size_t) 0, (size_t) 128})
+    {
+      ran = 0;
+      bool caught = false;
+      try
+      {
+        jobs.parallelFor(257, 1, [&ran, thrower](size_t begin, size_t end) {
+          ran.fetch_add((uint32_t) (end - begin), std::memory_order_relaxed);
+          if (begin == thrower) throw std::runtime_error("chunk failed");
+        });
+      }
+      catch (const std::runtime_error &) { caught = true; }
+      if (!caught || ran.load() != 257) failures++;
+    }
+  }
+
+  printf("jobs-stress: %u rounds on %u threads, %zu failures, %.2f ms\n", rounds, jobs.threads(), failures,
+         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+  if (failures) exit(1);
+}
+
+static void benchCull(std::vector<const char*> args)
+{
+  size_t count = args.empty() ? 1000000 : (size_t) atol(args[0]);
+
+  // Boxes scattered through a 200^3 volume around a camera looking down +x: roughly a tenth survive
+  AtomicCull cull;
+  cull.resize(count);
+  uint64_t seed = 1;
+  auto random = [&seed](float lo, float hi) { seed = spin(seed, 1); return lo + (hi - lo) * (float) ((seed >> 40) & 0xFFFFFF) / (float) 0xFFFFFF; };
+  for (size_t i = 0; i < count; i++)
+    cull.set(i, glm::vec3(random(-100, 100), random(-100, 100), random(-100, 100)), glm::vec3(random(0.1f, 1), random(0.1f, 1), random(0.1f, 1)));
+
+  glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+  AtomicCull::Frustum frustum = AtomicCull::frustum(proj * view);
+
+  AtomicJobs jobs;
+  std::vector<uint32_t> reference(count), visible(count);
+  size_t expected = cull.cull(frustum, reference.data(), AtomicCull::Scalar);
+
+  printf("cull: %zu boxes, %zu visible, best kernel %s\n", count, expected, AtomicCull::best() == AtomicCull::AVX ? "AVX" : AtomicCull::best() == AtomicCull::SSE ? "SSE" : "scalar");
+  printf("%-24s | %12s | %16s | %s\n", "kernel", "ms", "boxes/ms", "result");
+
+  struct Run { const char *name; AtomicCull::Kernel kernel; bool parallel; };
+  const Run runs[] = {
+    {"scalar", AtomicCull::Scalar, false},
+    {"sse", AtomicCull::SSE, false},
+    {"avx", AtomicCull::AVX, false},
+    {"parallel (best kernel)", AtomicCull::Auto, true},
+  };
+
+  for (const Run &run : runs)
+  {
+    if (run.kernel != AtomicCull::Auto && run.kernel > AtomicCull::best()) continue;
+
+    size_t found = 0;
+    double ms = bestOf(10, [&]() {
+      found = run.parallel ? cull.cullParallel(jobs, frustum, visible.data(), run.kernel) : cull.cull(frustum, visible.data(), run.kernel);
+    });
+
+    bool match = found == expected && std::equal(visible.begin(), visible.begin() + found, reference.begin());
+    printf("%-24s | %12.3f | %16.0f | %s\n", run.name, ms, count / ms, match ? "ok" : "MISMATCH");
+  }
+}
+
+static void benchMips(std::vector<const char*> args)
+{
+  uint32_t size = args.empty() ? 4096 : (uint32_t) atoi(args[0]);
+
+  // Noise over a gradient, with a varying alpha channel
+  std::vector<uint8_t> level0((size_t) size * size * 4);
+  uint64_t seed = 1;
+  for (size_t i = 0; i < level0.size(); i++)
+  {
+    seed = spin(seed, 1);
+    level0[i] = (uint8_t) ((i / 4 % size) * 255 / size / 2 + ((seed >> 40) & 0x7F));
+  }
+
+  // Full chain below level 0: every level filtered from the previous one
+  std::vector<std::vector<uint8_t>> chain;
+  for (uint32_t w = size, h = size; w > 1 || h > 1; w = std::max(1u, w / 2), h = std::max(1u, h / 2))
+    chain.emplace_back((size_t) std::max(1u, w / 2) * std::max(1u, h / 2) * 4);
+
+  auto build = [&](AtomicJobs *jobs, AtomicTexture::Kernel kernel) {
+    const uint8_t *src = level0.data();
+    uint32_t w = size, h = size;
+    for (auto &level : chain)
+    {
+      if (jobs) AtomicTexture::downsampleParallel(*jobs, src, w, h, level.data(), kernel);
+      else AtomicTexture::downsample(src, w, h, level.data(), kernel);
+      src = level.data();
+      w = std::max(1u, w / 2);
+      h = std::max(1u, h / 2);
+    }
+  };
+
+  AtomicJobs jobs;
+  build(nullptr, AtomicTexture::Scalar);
+  std::vector<std::vector<uint8_t>> reference = chain;
+
+  const char *names[] = {"scalar", "sse2", "avx2"};
+  printf("mips: %ux%u, %zu levels, best kernel %s, %u threads\n", size, size, chain.size() + 1, names[AtomicTexture::best()], jobs.threads());
+  printf("%-24s | %12s | %16s | %s\n", "kernel", "ms", "texels/ms", "result");
+
+  struct Run { const char *name; AtomicTexture::Kernel kernel; bool parallel; };
+  const Run runs[] = {
+    {"scalar", AtomicTexture::Scalar, false},
+    {"sse2", AtomicTexture::SSE, false},
+    {"avx2", AtomicTexture::AVX2, false},
+    {"parallel (best kernel)", AtomicTexture::Auto, true},
+  };
+
+  for (const Run &run : runs)
+  {
+    if (run.kernel != AtomicTexture::Auto && run.kernel > AtomicTexture::best()) continue;
+
+    double ms = bestOf(5, [&]() { build(run.parallel ? &jobs : nullptr, run.kernel); });
+    printf("%-24s | %12.3f | %16.0f | %s\n", run.name, ms, (double) size * size / ms, chain == reference ? "ok" : "MISMATCH");
+  }
+}
+
+int main(int argc, char **argv)
+{
+  std::string name = argc > 1 ? argv[1] : "weld";
+  std::vector<const char*> args(argv + std::min(argc, 2), argv + argc);
+
+  if (name == "weld") benchWeld(args);
+  else if (name == "jobs") benchJobs(args);
+  else if (name == "jobs-stress") benchJobsStress(args);
+  else if (name == "cull") benchCull(args);
+  else if (name == "mips") benchMips(args);
+  else
+  {
+    printf("Unknown benchmark: %s\n", name.c_str());
+    return 1;
+  }
+
+  return 0;
+}
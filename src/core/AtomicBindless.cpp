@@ -0,0 +1,211 @@
+/**
+ * AtomicBindless 0.1
+ */
+
+bool AtomicBindless::supported(VkPhysicalDevice physical_device)
+{
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  if (properties.apiVersion < VK_API_VERSION_1_2) return false;
+
+  VkPhysicalDeviceDescriptorIndexingFeatures indexing{};
+  indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+  VkPhysicalDeviceFeatures2 features{};
+  features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features.pNext = &indexing;
+  vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+  return features.features.shaderSampledImageArrayDynamicIndexing
+         && indexing.shaderSampledImageArrayNonUniformIndexing
+         && indexing.runtimeDescriptorArray
+         && indexing.descriptorBindingPartiallyBound
+         && indexing.descriptorBindingSampledImageUpdateAfterBind
+         && indexing.descriptorBindingUpdateUnusedWhilePending;
+}
+
+void AtomicBindless::enable(VkPhysicalDeviceDescriptorIndexingFeatures &features)
+{
+  features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+  features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+  features.runtimeDescriptorArray = VK_TRUE;
+  features.descriptorBindingPartiallyBound = VK_TRUE;
+  features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+  features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+}
+
+void AtomicBindless::init(VkPhysicalDevice physical_device, VkDevice d)
+{
+  device = d;
+
+  // Capacity: what the device allows in one update-after-bind set, per stage and in total
+  VkPhysicalDeviceDescriptorIndexingProperties indexing{};
+  indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+  VkPhysicalDeviceProperties2 properties{};
+  properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties.pNext = &indexing;
+  vkGetPhysicalDeviceProperties2(physical_device, &properties);
+
+  capacity = std::min<uint32_t>({BINDLESS_MAX_TEXTURES,
+                                 indexing.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                 indexing.maxDescriptorSetUpdateAfterBindSampledImages});
+
+  samplers[LinearRepeat] = createSampler(VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT);
+  samplers[LinearClamp] = createSampler(VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
+  samplers[NearestRepeat] = createSampler(VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST, VK_SAMPLER_ADDRESS_MODE_REPEAT);
+
+  // Layout: binding 0 the image array (slots may be empty and change while frames are pending), binding 1 the samplers
+  {
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    bindings[0].descriptorCount = capacity;
+    bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    bindings[1].descriptorCount = SamplerCount;
+    bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[1].pImmutableSamplers = samplers;
+
+    std::array<VkDescriptorBindingFlags, 2> flags = {
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+            0
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount = static_cast<uint32_t>(flags.size());
+    flagsInfo.pBindingFlags = flags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &flagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS)
+      throw std::runtime_error("failed to create bindless descriptor set layout!");
+  }
+
+  // Pool and set: allocated once, never recreated with the swapchain
+  {
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    poolSizes[0].descriptorCount = capacity;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLER;
+    poolSizes[1].descriptorCount = SamplerCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+      throw std::runtime_error("failed to create bindless descriptor pool!");
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, &set) != VK_SUCCESS)
+      throw std::runtime_error("failed to allocate bindless descriptor set!");
+  }
+
+  free_slots.resize(capacity);
+  for (uint32_t n = 0; n < capacity; n++) free_slots[n] = capacity - 1 - n;
+  released.clear();
+
+  if (ATOMICENGINE_DEBUG) printf("Bindless textures: %u slots\n", capacity);
+}
+
+void AtomicBindless::destroy()
+{
+  if (!device) return;
+
+  vkDestroyDescriptorPool(device, pool, nullptr);
+  vkDestroyDescriptorSetLayout(device, layout, nullptr);
+  for (auto &sampler : samplers) vkDestroySampler(device, sampler, nullptr);
+
+  pool = VK_NULL_HANDLE;
+  layout = VK_NULL_HANDLE;
+  set = VK_NULL_HANDLE;
+  free_slots.clear();
+  released.clear();
+  device = VK_NULL_HANDLE;
+}
+
+uint32_t AtomicBindless::add(VkImageView view)
+{
+  if (free_slots.empty()) return ~0u;
+
+  uint32_t slot = free_slots.back();
+  free_slots.pop_back();
+
+  VkDescriptorImageInfo imageInfo{};
+  imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  imageInfo.imageView = view;
+
+  VkWriteDescriptorSet write{};
+  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.dstSet = set;
+  write.dstBinding = 0;
+  write.dstArrayElement = slot;
+  write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+  write.descriptorCount = 1;
+  write.pImageInfo = &imageInfo;
+
+  vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+  return slot;
+}
+
+void AtomicBindless::release(uint32_t slot, uint64_t frame)
+{
+  if (slot < capacity) released.push_back({slot, frame});
+}
+
+void AtomicBindless::collect(uint64_t frame)
+{
+  for (size_t n = 0; n < released.size();)
+  {
+    if (released[n].second > frame) { n++; continue; }
+
+    free_slots.push_back(released[n].first);
+    released[n] = released.back();
+    released.pop_back();
+  }
+}
+
+VkSampler AtomicBindless::createSampler(VkFilter filter, VkSamplerMipmapMode mipmap_mode, VkSamplerAddressMode address_mode)
+{
+  // LOD is clamped per texture in the shader, so one sampler serves every residency state
+  VkSamplerCreateInfo samplerInfo{};
+  samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+  samplerInfo.magFilter = filter;
+  samplerInfo.minFilter = filter;
+  samplerInfo.addressModeU = address_mode;
+  samplerInfo.addressModeV = address_mode;
+  samplerInfo.addressModeW = address_mode;
+  samplerInfo.anisotropyEnable = VK_FALSE;
+  samplerInfo.maxAnisotropy = 16.0f;
+  samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+  samplerInfo.unnormalizedCoordinates = VK_FALSE;
+  samplerInfo.compareEnable = VK_FALSE;
+  samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+  samplerInfo.mipmapMode = mipmap_mode;
+  samplerInfo.minLod = 0.0f;
+  samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+  samplerInfo.mipLodBias = 0.0f;
+
+  VkSampler sampler;
+  if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+    throw std::runtime_error("failed to create texture sampler!");
+
+  return sampler;
+}
@@ -0,0 +1,58 @@
+/**
+ * AtomicBindless 0.1
+ *
+ * Bindless textures: one descriptor set for the device lifetime, holding a large
+ * update-after-bind array of sampled images and a few immutable shared samplers.
+ * Every resident texture owns a slot; shaders pick theirs by index (carried in the
+ * instance record), so new textures never touch the per-frame descriptor sets.
+ * A replaced texture gets a fresh slot and its old one is reused only once the
+ * frames that may still read it have retired, so slots in use are never rewritten.
+ */
+
+#ifndef ATOMICBINDLESS_H
+#define ATOMICBINDLESS_H
+
+#include <vulkan/vulkan.h>
+
+#define BINDLESS_MAX_TEXTURES       4096 // sampled images in the array, clamped to the device limit
+
+class AtomicBindless
+{
+ public:
+  // Shared samplers, binding 1; the shaders declare the same count
+  enum Sampler { LinearRepeat, LinearClamp, NearestRepeat, SamplerCount };
+
+  VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+  VkDescriptorSet set = VK_NULL_HANDLE;
+  uint32_t capacity = 0;
+
+  AtomicBindless () {}
+  AtomicBindless (const AtomicBindless&) = delete;
+  AtomicBindless& operator= (const AtomicBindless&) = delete;
+
+  // Descriptor indexing (Vulkan 1.2): non-uniform indexing, partially bound, update-after-bind and unused-while-pending
+  static bool supported(VkPhysicalDevice physical_device);
+  static void enable(VkPhysicalDeviceDescriptorIndexingFeatures &features);
+
+  void init(VkPhysicalDevice physical_device, VkDevice device);
+  void destroy();
+
+  // Write a view into a free slot (~0u: array full). Free slots are unused by pending frames, so this never waits.
+  uint32_t add(VkImageView view);
+
+  // No frame from `frame` on references the slot; collect() hands it out again once earlier frames have retired
+  void release(uint32_t slot, uint64_t frame);
+  void collect(uint64_t frame);  // every frame before `frame` has completed
+
+  uint32_t used() const { return capacity - (uint32_t) free_slots.size(); }
+
+ private:
+  VkDevice device = VK_NULL_HANDLE;         VkDescriptorPool pool = VK_NULL_HANDLE;
+  VkSampler samplers[SamplerCount] = {};
+  std::vector<uint32_t> free_slots;         // popped from the back: lowest slot first
+  std::vector<std::pair<uint32_t, uint64_t>> released;  // slot, first frame that no longer uses it
+
+  VkSampler createSampler(VkFilter filter, VkSamplerMipmapMode mipmap_mode, VkSamplerAddressMode address_mode);
+};
+
+#endif //ATOMICBINDLESS_H
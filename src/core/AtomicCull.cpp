@@ -0,0 +1,198 @@
+/**
+ * AtomicCull 0.1
+ */
+
+// Gribb-Hartmann: planes are sums/differences of the clip matrix rows (depth in [0, 1])
+AtomicCull::Frustum AtomicCull::frustum(const glm::mat4 &m)
+{
+  glm::vec4 row[4];
+  for (int r = 0; r < 4; r++) row[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+
+  glm::vec4 planes[6] = { row[3] + row[0], row[3] - row[0], row[3] + row[1], row[3] - row[1], row[2], row[3] - row[2] };
+
+  Frustum frustum;
+  for (int p = 0; p < 6; p++)
+  {
+    float length = glm::length(glm::vec3(planes[p]));
+    if (length > 0) planes[p] /= length;
+
+    frustum.a[p] = planes[p].x;
+    frustum.b[p] = planes[p].y;
+    frustum.c[p] = planes[p].z;
+    frustum.d[p] = planes[p].w;
+  }
+
+  return frustum;
+}
+
+void AtomicCull::resize(size_t n)
+{
+  count = n;
+  for (auto *lane : {&cx, &cy, &cz, &ex, &ey, &ez}) lane->resize(n);
+}
+
+void AtomicCull::set(size_t i, const glm::vec3 &center, const glm::vec3 &extent)
+{
+  cx[i] = center.x; cy[i] = center.y; cz[i] = center.z;
+  ex[i] = extent.x; ey[i] = extent.y; ez[i] = extent.z;
+}
+
+// Arvo: the new half extent on each axis is the absolute 3x3 part applied to the old one
+void AtomicCull::setTransformed(size_t i, const glm::mat4 &model, const glm::vec3 &min, const glm::vec3 &max)
+{
+  float w = model[3][3] != 0.0f ? 1.0f / model[3][3] : 1.0f;
+  glm::vec3 center = (min + max) * 0.5f, extent = (max - min) * 0.5f;
+
+  glm::vec3 world_center = glm::vec3(model * glm::vec4(center, 1.0f)) * w, world_extent;
+  for (int axis = 0; axis < 3; axis++)
+    world_extent[axis] = (std::fabs(model[0][axis]) * extent.x + std::fabs(model[1][axis]) * extent.y + std::fabs(model[2][axis]) * extent.z) * std::fabs(w);
+
+  set(i, world_center, world_extent);
+}
+
+size_t AtomicCull::cull(const Frustum &frustum, uint32_t *visible, size_t begin, size_t end, Kernel kernel) const
+{
+  end = std::min(end, count);
+  if (begin >= end) return 0;
+  if (kernel == Auto) kernel = best();
+
+#if CULL_X86
+  if (kernel == AVX) return cullAVX(frustum, visible, begin, end);
+  if (kernel == SSE) return cullSSE(frustum, visible, begin, end);
+#endif
+
+  return cullScalar(frustum, visible, begin, end);
+}
+
+size_t AtomicCull::cullParallel(AtomicJobs &jobs, const Frustum &frustum, uint32_t *visible, Kernel kernel) const
+{
+  size_t chunks = (count + CULL_GRAIN - 1) / CULL_GRAIN;
+  if (chunks <= 1) return cull(frustum, visible, kernel);
+
+  // Each chunk compacts into its own span of `visible`, then the spans are closed up in order
+  std::vector<size_t> found(chunks);
+  jobs.parallelFor(chunks, 1, [&](size_t begin, size_t end)
+  {
+    for (size_t chunk = begin; chunk < end; chunk++)
+      found[chunk] = cull(frustum, visible + chunk * CULL_GRAIN, chunk * CULL_GRAIN, (chunk + 1) * CULL_GRAIN, kernel);
+  });
+
+  size_t total = found[0];
+  for (size_t chunk = 1; chunk < chunks; chunk++)
+  {
+    memmove(visible + total, visible + chunk * CULL_GRAIN, found[chunk] * sizeof(uint32_t));
+    total += found[chunk];
+  }
+
+  return total;
+}
+
+AtomicCull::Kernel AtomicCull::best()
+{
+#if CULL_X86 && (defined(__GNUC__) || defined(__clang__))
+  static const Kernel kernel = __builtin_cpu_supports("avx") ? AVX : __builtin_cpu_supports("sse") ? SSE : Scalar;
+  return kernel;
+#elif CULL_X86
+  return SSE;
+#else
+  return Scalar;
+#endif
+}
+
+// A box is out once it lies entirely behind one plane: distance of its center < -(projected half extent)
+size_t AtomicCull::cullScalar(const Frustum &f, uint32_t *visible, size_t begin, size_t end) const
+{
+  size_t n = 0;
+
+  for (size_t i = begin; i < end; i++)
+  {
+    bool inside = true;
+    for (int p = 0; p < 6 && inside; p++)
+    {
+      float distance = f.a[p] * cx[i] + f.b[p] * cy[i] + f.c[p] * cz[i] + f.d[p];
+      float radius = std::fabs(f.a[p]) * ex[i] + std::fabs(f.b[p]) * ey[i] + std::fabs(f.c[p]) * ez[i];
+      inside = distance + radius >= 0.0f;
+    }
+
+    visible[n] = (uint32_t) i;
+    n += inside;
+  }
+
+  return n;
+}
+
+#if CULL_X86
+
+// 4 boxes per iteration; the movemask of the surviving lanes drives the compaction
+__attribute__((target("sse")))
+size_t AtomicCull::cullSSE(const Frustum &f, uint32_t *visible, size_t begin, size_t end) const
+{
+  __m128 a[6], b[6], c[6], d[6], abs_a[6], abs_b[6], abs_c[6];
+  const __m128 sign = _mm_set1_ps(-0.0f), zero = _mm_setzero_ps();
+
+  for (int p = 0; p < 6; p++)
+  {
+    a[p] = _mm_set1_ps(f.a[p]); abs_a[p] = _mm_andnot_ps(sign, a[p]);
+    b[p] = _mm_set1_ps(f.b[p]); abs_b[p] = _mm_andnot_ps(sign, b[p]);
+    c[p] = _mm_set1_ps(f.c[p]); abs_c[p] = _mm_andnot_ps(sign, c[p]);
+    d[p] = _mm_set1_ps(f.d[p]);
+  }
+
+  size_t n = 0, i = begin;
+  for (; i + 4 <= end; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(&cx[i]), y = _mm_loadu_ps(&cy[i]), z = _mm_loadu_ps(&cz[i]);
+    __m128 hx = _mm_loadu_ps(&ex[i]), hy = _mm_loadu_ps(&ey[i]), hz = _mm_loadu_ps(&ez[i]);
+    __m128 inside = _mm_cmpeq_ps(zero, zero);
+
+    for (int p = 0; p < 6; p++)
+    {
+      __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[p], x), _mm_mul_ps(b[p], y)), _mm_add_ps(_mm_mul_ps(c[p], z), d[p]));
+      __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_a[p], hx), _mm_mul_ps(abs_b[p], hy)), _mm_mul_ps(abs_c[p], hz));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+    }
+
+    for (unsigned mask = (unsigned) _mm_movemask_ps(inside); mask; mask &= mask - 1)
+      visible[n++] = (uint32_t) (i + __builtin_ctz(mask));
+  }
+
+  return n + cullScalar(f, visible + n, i, end);
+}
+
+// 8 boxes per iteration
+__attribute__((target("avx")))
+size_t AtomicCull::cullAVX(const Frustum &f, uint32_t *visible, size_t begin, size_t end) const
+{
+  __m256 a[6], b[6], c[6], d[6], abs_a[6], abs_b[6], abs_c[6];
+  const __m256 sign = _mm256_set1_ps(-0.0f), zero = _mm256_setzero_ps();
+
+  for (int p = 0; p < 6; p++)
+  {
+    a[p] = _mm256_set1_ps(f.a[p]); abs_a[p] = _mm256_andnot_ps(sign, a[p]);
+    b[p] = _mm256_set1_ps(f.b[p]); abs_b[p] = _mm256_andnot_ps(sign, b[p]);
+    c[p] = _mm256_set1_ps(f.c[p]); abs_c[p] = _mm256_andnot_ps(sign, c[p]);
+    d[p] = _mm256_set1_ps(f.d[p]);
+  }
+
+  size_t n = 0, i = begin;
+  for (; i + 8 <= end; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(&cx[i]), y = _mm256_loadu_ps(&cy[i]), z = _mm256_loadu_ps(&cz[i]);
+    __m256 hx = _mm256_loadu_ps(&ex[i]), hy = _mm256_loadu_ps(&ey[i]), hz = _mm256_loadu_ps(&ez[i]);
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    for (int p = 0; p < 6; p++)
+    {
+      __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[p], x), _mm256_mul_ps(b[p], y)), _mm256_add_ps(_mm256_mul_ps(c[p], z), d[p]));
+      __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(abs_a[p], hx), _mm256_mul_ps(abs_b[p], hy)), _mm256_mul_ps(abs_c[p], hz));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+    }
+
+    for (unsigned mask = (unsigned) _mm256_movemask_ps(inside); mask; mask &= mask - 1)
+      visible[n++] = (uint32_t) (i + __builtin_ctz(mask));
+  }
+
+  return n + cullSSE(f, visible + n, i, end);
+}
+
+#endif
@@ -0,0 +1,65 @@
+/**
+ * AtomicCull 0.1
+ *
+ * Frustum culling over bounding boxes kept as structure-of-arrays (centers and
+ * half extents), tested 4 (SSE) or 8 (AVX) at a time against the six planes of
+ * a view-projection matrix. Survivors come out as a compacted index list.
+ */
+
+#ifndef ATOMICCULL_H
+#define ATOMICCULL_H
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CULL_X86                    1
+#else
+#define CULL_X86                    0
+#endif
+
+#define CULL_GRAIN                  16384  // boxes per job when bounds and culling are split across workers
+
+class AtomicCull
+{
+ public:
+  enum Kernel { Scalar, SSE, AVX, Auto };
+
+  // Inward-facing, normalized planes: left, right, bottom, top, near, far
+  struct Frustum { float a[6], b[6], c[6], d[6]; };
+  static Frustum frustum(const glm::mat4 &view_proj);
+
+  AtomicCull () {}
+  AtomicCull (const AtomicCull&) = delete;
+  AtomicCull& operator= (const AtomicCull&) = delete;
+
+  void resize(size_t count);
+  size_t size() const { return count; }
+
+  void set(size_t i, const glm::vec3 &center, const glm::vec3 &extent);
+  glm::vec3 center(size_t i) const { return glm::vec3(cx[i], cy[i], cz[i]); }
+  glm::vec3 extent(size_t i) const { return glm::vec3(ex[i], ey[i], ez[i]); }
+
+  // World-space box around a local [min, max] box under an affine transform (its w row may carry a uniform scale)
+  void setTransformed(size_t i, const glm::mat4 &model, const glm::vec3 &min, const glm::vec3 &max);
+
+  // Indices in [begin, end) of boxes touching the frustum, in order, compacted into `visible`; returns how many
+  size_t cull(const Frustum &frustum, uint32_t *visible, size_t begin, size_t end, Kernel kernel = Auto) const;
+  size_t cull(const Frustum &frustum, uint32_t *visible, Kernel kernel = Auto) const { return cull(frustum, visible, 0, count, kernel); }
+
+  // Same output as cull(), split into CULL_GRAIN chunks on the job system
+  size_t cullParallel(AtomicJobs &jobs, const Frustum &frustum, uint32_t *visible, Kernel kernel = Auto) const;
+
+  // Widest kernel this CPU (and OS) can run
+  static Kernel best();
+
+ private:
+  size_t count = 0;
+  std::vector<float> cx, cy, cz, ex, ey, ez;
+
+  size_t cullScalar(const Frustum &frustum, uint32_t *visible, size_t begin, size_t end) const;
+#if CULL_X86
+  size_t cullSSE(const Frustum &frustum, uint32_t *visible, size_t begin, size_t end) const;
+  size_t cullAVX(const Frustum &frustum, uint32_t *visible, size_t begin, size_t end) const;
+#endif
+};
+
+#endif //ATOMICCULL_H
@@ -4,10 +4,18 @@
 
 void AtomicEngine::mainLoop()
 {
+  scheduler.start(GPU.frame_cap);
+  GPU.startRenderThread();
+
   while (active)
   {
+    // Sleep until the next frame is due instead of spinning
+    scheduler.wait();
+
+    // One input snapshot per tick
+    atomicengine_input.update();
+
     // Input Handler Todo: handle down-events
-    if (timer.test(120, TIMER_INPUT_KEYS-1))
     {
       // Test Scale IN
       if (keyPressed(GLFW_KEY_5))
@@ -40,16 +48,23 @@ void AtomicEngine::mainLoop()
           printf("Scale target: %.2f\n", GPU.test_scale);
       }
 
-      // Test Mip
+      // Test Mip: forced min LOD, applied by the shader from the next frame
       if (keyPressed(GLFW_KEY_1))
       {
         GPU.test_mip = fmod(GPU.test_mip + 0.10, 0.60);
-        GPU.reload();
 
         if (ATOMICENGINE_DEBUG)
           printf("Mip target: %.2f\n", GPU.test_mip);
       }
 
+      // Test Instances: 1, 10, ... 10000 copies of the model
+      if (keyPressed(GLFW_KEY_6))
+      {
+        GPU.test_instances = GPU.test_instances >= 10000 ? 1 : GPU.test_instances * 10;
+        if (ATOMICENGINE_DEBUG)
+          printf("Instances: %u\n", GPU.test_instances);
+      }
+
       // Esc / Close application
       if (keyPressed(GLFW_KEY_ESCAPE))
         GPU.status = 3;
@@ -59,6 +74,11 @@ void AtomicEngine::mainLoop()
     if (GLTF.status>=5) GLTF.callback();
     else if (GLTF.status==3) GLTF.exit();
 
+    // Fixed-timestep simulation, rendered interpolated
+    for (unsigned step = 0; step < scheduler.steps(); step++)
+      GPU.simulate(scheduler.stepSeconds());
+    GPU.interpolation = scheduler.alpha();
+
     // GPU: Cycle / Exit
     if (GPU.status>=5) GPU.callback();
     else if (GPU.status==3) GPU.exit();
@@ -81,48 +101,75 @@ void AtomicEngine::exit() { active = false; }
 
 void AtomicEngine::input_recorder_keyboard(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-  atomicengine_input_map.keys_prev[key] = atomicengine_input_map.keys[key];
-  atomicengine_input_map.keys[key] = action;
+  atomicengine_input.push(AtomicInput::Key, key, action);
   //printf("Key Input Read: %d, %d, %d, %d\n", key, scancode, action, mods);
 }
 
 void AtomicEngine::input_recorder_mouse_coords(GLFWwindow* window, double x, double y)
 {
-  atomicengine_input_map.mouse_coords[0] = x;
-  atomicengine_input_map.mouse_coords[1] = y;
+  atomicengine_input.push(AtomicInput::MouseMove, 0, 0, x, y);
   //printf("Mouse Coord Read: %f, %f\n", x, y);
 }
 
 void AtomicEngine::input_recorder_mouse(GLFWwindow* window, int button, int action, int mods)
 {
-  atomicengine_input_map.mouse_prev[button] = atomicengine_input_map.mouse[button];
-  atomicengine_input_map.mouse[button] = action;
+  atomicengine_input.push(AtomicInput::MouseButton, button, action);
   //printf("Mouse Input Read: %d, %d\n", button, action);
 }
 
 void AtomicEngine::input_recorder_scroll(GLFWwindow* window, double x, double y)
 {
-  atomicengine_input_map.scroll[0] = x;
-  atomicengine_input_map.scroll[1] = y;
+  atomicengine_input.push(AtomicInput::Scroll, 0, 0, x, y);
   //printf("Scroll Input Read: %f, %f\n", x, y);
 }
 
+// A press counts once it is released, or at the repeat rate while held
 bool AtomicEngine::keyPressed(int key)
 {
-  // Repeat
-  if (atomicengine_input_map.keys[key] == GLFW_REPEAT
-      && timer.test(INPUT_KEYS_REPEAT_INTERVAL, TIMER_INPUT_KEYS+key))
-    return 1;
+  const AtomicInput::Snapshot &input = atomicengine_input.snapshot();
+  if (key < 0 || key >= INPUT_KEY_COUNT) return 0;
 
   // Pressed
-  if (atomicengine_input_map.keys_prev[key] == GLFW_PRESS
-      && atomicengine_input_map.keys[key] == GLFW_RELEASE)
-  { atomicengine_input_map.keys_prev[key] = 0; return 1; } else return 0;
+  if (input.key_releases[key]) return 1;
+
+  // Repeat
+  if (input.keys[key] == GLFW_REPEAT)
+  {
+    auto repeat = key_repeat_timers.find(key);
+    if (repeat == key_repeat_timers.end())
+      repeat = key_repeat_timers.emplace(key, timer.create("input.key_repeat", INPUT_KEYS_REPEAT_INTERVAL)).first;
+
+    return timer.test(repeat->second);
+  }
+
+  return 0;
 }
 
 bool AtomicEngine::mousePressed(int button)
 {
-  if (atomicengine_input_map.mouse_prev[button] == GLFW_PRESS
-      && atomicengine_input_map.mouse[button] == GLFW_RELEASE)
-  { atomicengine_input_map.mouse_prev[button] = 0; return 1; } else return 0;
-}
\ No newline at end of file
+  const AtomicInput::Snapshot &input = atomicengine_input.snapshot();
+  return button >= 0 && button < INPUT_MOUSE_COUNT && input.mouse_releases[button];
+}
+
+bool atomicengine_write_file(const std::string &path, const std::function<void(std::ofstream&)> &write)
+{
+  std::string tmp_path = path + ".tmp";
+  std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) return false;
+
+  write(file);
+  file.close();
+
+  if (!file || rename(tmp_path.c_str(), path.c_str()) != 0)
+  {
+    remove(tmp_path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool atomicengine_write_file(const std::string &path, const void *data, size_t size)
+{
+  return atomicengine_write_file(path, [&](std::ofstream &file) { file.write((const char*) data, (std::streamsize) size); });
+}
@@ -24,39 +24,48 @@
 #include <array>
 #include <optional>
 #include <unordered_map>
+#include <functional>
 #include <sys/time.h>
 
 #define ATOMICENGINE_DEBUG          1
 
-#define TIMER_FPS                   0x00
-#define INPUT_KEYS_REPEAT_INTERVAL  16
-#define TIMER_INPUT_KEYS            0x1000 + 1 + 0x200
-#define TIMER_GLTF                  0x2000
+#define INPUT_KEYS_REPEAT_INTERVAL  16  // repeats per second while a key is held
 
 #define Min(a,b) a<b?a:b
 #define Max(a,b) a>b?a:b
 
 class AtomicEngine;
 
+// Write through a temporary file and rename, so a crash never leaves a torn file behind (caches, blobs)
+bool atomicengine_write_file(const std::string &path, const std::function<void(std::ofstream&)> &write);
+bool atomicengine_write_file(const std::string &path, const void *data, size_t size);
+
+#include "AtomicJobs.h"
+#include "AtomicTimer.h"
+#include "AtomicScheduler.h"
+#include "AtomicMesh.h"
+#include "AtomicMemory.h"
+#include "AtomicTexture.h"
+#include "AtomicResidency.h"
+#include "AtomicUpload.h"
+#include "AtomicShader.h"
+#include "AtomicBindless.h"
 #include "AtomicVK.h"
 #include "AtomicGLTF.h"
+#include "AtomicInput.h"
 
-static struct {
-  int    keys[0x15C]        = {0}, // key => action
-         keys_prev[0x15C]   = {0}, // key => action
-         mouse[0xFF]        = {0}, // key => action
-         mouse_prev[0x15C]  = {0}; // key => action
-  double mouse_coords[0x01] = {0}, // X, Y
-         scroll[0x01]       = {0}; // X, Y
-} atomicengine_input_map;
+static AtomicInput atomicengine_input; // fed by the static GLFW callbacks
 
 bool _load_model = false;
 
 class AtomicEngine
 {
  public:
+  AtomicJobs jobs;   // worker pool sized to the hardware cores, shared by all subsystems
+  AtomicTimer timer; // constructed first: subsystems register their timers during init
   AtomicVK GPU;
   AtomicGLTF GLTF;
+  AtomicScheduler scheduler;
   bool active = false;
 
   long int engine_started,
@@ -98,27 +107,6 @@ class AtomicEngine
   void mainLoop();
   void exit();
 
-  // Timer Struct
-  struct
-  {
-    double stack[0xFFFFF];
-
-    struct timeval tp;
-    long unsigned getS () { return getMS() / 1000; }
-    long unsigned getMS()
-    {
-      gettimeofday(&tp,NULL);
-      return tp.tv_sec * 1000 + tp.tv_usec / 1000;
-    }
-
-    bool test (long unsigned occur, long unsigned index=0, double timelen=1000, bool rtn=0)
-    {
-      unsigned long ms = getMS();
-      if (rtn = (ms-stack[index]) >= (double) (timelen/occur))
-        stack[index] = ms;
-      return rtn;
-    }
-  } timer;
 
   // Input recorders
   static void input_recorder_keyboard(GLFWwindow* window, int key, int scancode, int action, int mods);
@@ -126,6 +114,7 @@ class AtomicEngine
   static void input_recorder_mouse(GLFWwindow* window, int button, int action, int mods);
   static void input_recorder_scroll(GLFWwindow* window, double x, double y);
   bool keyPressed(int key); bool mousePressed(int key);
+  std::unordered_map<int, AtomicTimer::Handle> key_repeat_timers;
 
  protected:
 
@@ -133,7 +122,21 @@ class AtomicEngine
 };
 
 #include "AtomicEngine.cpp"
+#include "AtomicJobs.cpp"
+#include "AtomicTimer.cpp"
+#include "AtomicScheduler.cpp"
+#include "AtomicMesh.cpp"
+#include "AtomicMemory.cpp"
+#include "AtomicTexture.cpp"
+#include "AtomicResidency.cpp"
+#include "AtomicUpload.cpp"
+#include "AtomicShader.cpp"
+#include "AtomicBindless.cpp"
+#include "AtomicVertex.cpp"
+#include "AtomicScene.cpp"
+#include "AtomicCull.cpp"
 #include "AtomicVK.cpp"
 #include "AtomicGLTF.cpp"
+#include "AtomicInput.cpp"
 
 #endif //ATOMICENGINE_H
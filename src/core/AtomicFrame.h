@@ -0,0 +1,49 @@
+/**
+ * AtomicFrame 0.1
+ *
+ * Frame packet handed from the simulation thread to the render thread through
+ * a lock-free triple buffer: the writer never waits, the reader always gets the
+ * newest complete packet.
+ */
+
+#ifndef ATOMICFRAME_H
+#define ATOMICFRAME_H
+
+#include <atomic>
+#include <vector>
+
+template <typename T>
+class AtomicTripleBuffer
+{
+ public:
+  // Writer
+  T& back() { return slots[back_index]; }
+  void publish() { back_index = middle.exchange(back_index | FRESH, std::memory_order_acq_rel) & INDEX; }
+
+  // Reader
+  bool fresh() const { return middle.load(std::memory_order_acquire) & FRESH; }
+  bool fetch()
+  {
+    if (!fresh()) return false;
+    front_index = middle.exchange(front_index, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+  const T& front() const { return slots[front_index]; }
+
+ private:
+  static constexpr uint32_t INDEX = 3, FRESH = 4;
+
+  T slots[3];
+  uint32_t back_index = 0, front_index = 1;  // owned by writer / reader
+  std::atomic<uint32_t> middle{2};           // last published slot, FRESH until fetched
+};
+
+struct AtomicFrame
+{
+  uint64_t tick = 0;
+  glm::mat4 view, camera_view;
+  float fov = 45.0f, z_near = 0.1f, z_far = 10.0f; // projection is finished on the render thread, which owns the extent
+  std::vector<AtomicScene::Instance> instances; // cleared, not freed, between frames
+};
+
+#endif //ATOMICFRAME_H
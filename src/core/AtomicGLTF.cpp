@@ -6,7 +6,7 @@ void AtomicGLTF::callback()
 {
   if (status>=5)
   {
-    if (engine->timer.test(120, TIMER_GLTF+1))
+    if (engine->timer.test(callback_timer))
     {
       //printf("GLTF CALLBACK\n");
     }
@@ -15,8 +15,516 @@ void AtomicGLTF::callback()
   else status = 3;
 }
 
+void AtomicGLTF::initTimers()
+{
+  callback_timer = engine->timer.create("gltf.callback", 120);
+}
+
 void AtomicGLTF::exit()
 {
   status = 2;
   printf("Exiting GLTF\n");
-}
\ No newline at end of file
+}
+
+bool AtomicGLTF::isGLTF(const char *path)
+{
+  size_t len = strlen(path);
+  return (len > 5 && strcasecmp(path + len - 5, ".gltf") == 0)
+      || (len > 4 && strcasecmp(path + len - 4, ".glb") == 0);
+}
+
+/**
+ * JSON
+ */
+
+const AtomicGLTF::Json& AtomicGLTF::Json::operator[](const char *key) const
+{
+  static const Json none;
+  for (const auto &kv : object)
+    if (kv.first == key) return kv.second;
+  return none;
+}
+
+bool AtomicGLTF::Json::parse(const char *&p, const char *end, Json &out)
+{
+  auto skip = [&]() { while (p < end && (*p==' ' || *p=='\n' || *p=='\r' || *p=='\t')) p++; };
+
+  auto parseString = [&](std::string &s) -> bool
+  {
+    if (p >= end || *p != '"') return false;
+    for (p++; p < end && *p != '"'; p++)
+    {
+      if (*p != '\\') { s += *p; continue; }
+      if (++p >= end) return false;
+      switch (*p)
+      {
+        case 'n': s += '\n'; break;   case 't': s += '\t'; break;
+        case 'r': s += '\r'; break;   case 'b': s += '\b'; break;
+        case 'f': s += '\f'; break;
+        case 'u':
+        {
+          if (end - p < 5) return false;
+          unsigned cp = (unsigned) strtoul(std::string(p+1, 4).c_str(), nullptr, 16);
+          p += 4;
+          if (cp < 0x80) s += (char) cp;
+          else if (cp < 0x800) { s += (char) (0xC0 | (cp>>6)); s += (char) (0x80 | (cp&0x3F)); }
+          else { s += (char) (0xE0 | (cp>>12)); s += (char) (0x80 | ((cp>>6)&0x3F)); s += (char) (0x80 | (cp&0x3F)); }
+          break;
+        }
+        default: s += *p;
+      }
+    }
+    if (p >= end) return false;
+    p++;
+    return true;
+  };
+
+  skip();
+  if (p >= end) return false;
+
+  switch (*p)
+  {
+    case '{':
+    {
+      out.type = Object;
+      p++; skip();
+      if (p < end && *p == '}') { p++; return true; }
+      while (p < end)
+      {
+        std::pair<std::string, Json> kv;
+        skip();
+        if (!parseString(kv.first)) return false;
+        skip();
+        if (p >= end || *p++ != ':') return false;
+        if (!parse(p, end, kv.second)) return false;
+        out.object.push_back(std::move(kv));
+        skip();
+        if (p < end && *p == ',') { p++; continue; }
+        if (p < end && *p == '}') { p++; return true; }
+        return false;
+      }
+      return false;
+    }
+
+    case '[':
+    {
+      out.type = Array;
+      p++; skip();
+      if (p < end && *p == ']') { p++; return true; }
+      while (p < end)
+      {
+        out.array.emplace_back();
+        if (!parse(p, end, out.array.back())) return false;
+        skip();
+        if (p < end && *p == ',') { p++; continue; }
+        if (p < end && *p == ']') { p++; return true; }
+        return false;
+      }
+      return false;
+    }
+
+    case '"':
+      out.type = String;
+      return parseString(out.string);
+
+    case 't': case 'f': case 'n':
+    {
+      const char *word = *p=='t' ? "true" : *p=='f' ? "false" : "null";
+      size_t len = strlen(word);
+      if ((size_t) (end - p) < len || strncmp(p, word, len) != 0) return false;
+      out.type = *p=='n' ? Null : Bool;
+      out.boolean = *p=='t';
+      p += len;
+      return true;
+    }
+
+    default:
+    {
+      char *num_end;
+      std::string token(p, std::min<size_t>(end - p, 64));
+      out.number = strtod(token.c_str(), &num_end);
+      if (num_end == token.c_str()) return false;
+      out.type = Number;
+      p += num_end - token.c_str();
+      return true;
+    }
+  }
+}
+
+/**
+ * Asset
+ */
+
+void AtomicGLTF::Asset::load(const char *path)
+{
+  release();
+
+  std::string base_dir = path;
+  size_t slash = base_dir.find_last_of('/');
+  base_dir = slash == std::string::npos ? "" : base_dir.substr(0, slash+1);
+
+  std::span<const uint8_t> file = map(path);
+  std::span<const char> json_text((const char*) file.data(), file.size());
+  std::span<const uint8_t> glb_bin;
+
+  // GLB: 12-byte header, JSON chunk, optional BIN chunk
+  if (file.size() >= 12 && *(const uint32_t*) file.data() == GLTF_GLB_MAGIC)
+  {
+    const uint32_t *header = (const uint32_t*) file.data();
+    if (header[1] != 2 || header[2] > file.size())
+      throw std::runtime_error("unsupported GLB container!");
+
+    size_t offset = 12;
+    while (offset + 8 <= header[2])
+    {
+      uint32_t chunk_length = *(const uint32_t*) (file.data() + offset),
+               chunk_type   = *(const uint32_t*) (file.data() + offset + 4);
+      if (offset + 8 + chunk_length > header[2])
+        throw std::runtime_error("truncated GLB chunk!");
+
+      if (chunk_type == GLTF_GLB_CHUNK_JSON)
+        json_text = std::span<const char>((const char*) file.data() + offset + 8, chunk_length);
+      else if (chunk_type == GLTF_GLB_CHUNK_BIN && glb_bin.empty())
+        glb_bin = file.subspan(offset + 8, chunk_length);
+
+      offset += 8 + ((chunk_length + 3) & ~3u);
+    }
+  }
+
+  Json json;
+  const char *p = json_text.data();
+  if (!Json::parse(p, json_text.data() + json_text.size(), json))
+    throw std::runtime_error(std::string("failed to parse glTF JSON: ") + path);
+
+  parse(json, glb_bin, base_dir);
+
+  if (ATOMICENGINE_DEBUG)
+    printf("Loaded glTF: %s (%zu meshes, %zu accessors)\n", path, meshes.size(), accessors.size());
+}
+
+void AtomicGLTF::Asset::parse(const Json &json, std::span<const uint8_t> glb_bin, const std::string &base_dir)
+{
+  static const struct { const char *name; uint8_t components; } types[] =
+    { {"SCALAR",1}, {"VEC2",2}, {"VEC3",3}, {"VEC4",4}, {"MAT2",4}, {"MAT3",9}, {"MAT4",16} };
+
+  if (json["asset"]["version"].str().rfind("2", 0) != 0)
+    throw std::runtime_error("only glTF 2.0 is supported!");
+
+  // Buffers: GLB chunk, mapped .bin files or base64 data URIs
+  const Json &jbuffers = json["buffers"];
+  for (size_t i=0; i<jbuffers.size(); i++)
+  {
+    const Json &jb = jbuffers[i];
+    size_t length = (size_t) jb["byteLength"].integer();
+    std::span<const uint8_t> data;
+
+    if (!jb.has("uri"))
+      data = glb_bin;
+    else if (jb["uri"].str().rfind("data:", 0) == 0)
+    {
+      const std::string &uri = jb["uri"].str();
+      size_t comma = uri.find(',');
+      if (comma == std::string::npos || uri.find(";base64") == std::string::npos)
+        throw std::runtime_error("unsupported glTF data URI!");
+
+      std::unique_ptr<uint8_t[]> bytes(new uint8_t[uri.size()]);
+      size_t n = 0; uint32_t acc = 0; int bits = 0;
+      for (size_t c = comma+1; c < uri.size() && uri[c] != '='; c++)
+      {
+        const char *table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        const char *pos = strchr(table, uri[c]);
+        if (!pos || !*pos) continue;
+        acc = (acc << 6) | (uint32_t) (pos - table);
+        if ((bits += 6) >= 8) bytes[n++] = (uint8_t) (acc >> (bits -= 8));
+      }
+      data = std::span<const uint8_t>(bytes.get(), n);
+      owned.push_back(std::move(bytes));
+    }
+    else
+      data = map(base_dir + jb["uri"].str());
+
+    if (data.size() < length)
+      throw std::runtime_error("glTF buffer is shorter than its byteLength!");
+
+    buffers.push_back({ data.first(length) });
+  }
+
+  const Json &jviews = json["bufferViews"];
+  for (size_t i=0; i<jviews.size(); i++)
+  {
+    const Json &jv = jviews[i];
+    BufferView v;
+    v.buffer = (uint32_t) jv["buffer"].integer();
+    v.offset = (size_t) jv["byteOffset"].integer();
+    v.length = (size_t) jv["byteLength"].integer();
+    v.stride = (size_t) jv["byteStride"].integer();
+    v.target = (uint32_t) jv["target"].integer();
+
+    if (v.buffer >= buffers.size() || v.offset + v.length > buffers[v.buffer].data.size())
+      throw std::runtime_error("glTF bufferView out of range!");
+    views.push_back(v);
+  }
+
+  const Json &jaccessors = json["accessors"];
+  for (size_t i=0; i<jaccessors.size(); i++)
+  {
+    const Json &ja = jaccessors[i];
+    Accessor a;
+    a.view = (int32_t) ja["bufferView"].integer(-1);
+    a.offset = (size_t) ja["byteOffset"].integer();
+    a.component_type = (uint32_t) ja["componentType"].integer();
+    a.count = (uint32_t) ja["count"].integer();
+    a.normalized = ja["normalized"].boolean;
+
+    for (const auto &t : types)
+      if (ja["type"].str() == t.name) a.components = t.components;
+
+    for (uint32_t c=0; c<3; c++)
+    {
+      a.min[c] = (float) ja["min"][c].number;
+      a.max[c] = (float) ja["max"][c].number;
+    }
+    a.bounded = ja["min"].size() >= a.components && ja["max"].size() >= a.components;
+
+    if (ja.has("sparse"))
+      throw std::runtime_error("sparse glTF accessors are not supported!");
+    if (a.view >= (int32_t) views.size() || (a.view >= 0 && a.count && a.offset + stride(a) * (a.count-1) + elementSize(a) > views[a.view].length))
+      throw std::runtime_error("glTF accessor out of range!");
+    accessors.push_back(a);
+  }
+
+  const Json &jmeshes = json["meshes"];
+  for (size_t i=0; i<jmeshes.size(); i++)
+  {
+    const Json &jm = jmeshes[i];
+    Mesh m;
+    m.name = jm["name"].str();
+
+    for (size_t j=0; j<jm["primitives"].size(); j++)
+    {
+      const Json &jp = jm["primitives"][j];
+      Primitive pr;
+      pr.position = (int32_t) jp["attributes"]["POSITION"].integer(-1);
+      pr.normal   = (int32_t) jp["attributes"]["NORMAL"].integer(-1);
+      pr.texcoord = (int32_t) jp["attributes"]["TEXCOORD_0"].integer(-1);
+      pr.indices  = (int32_t) jp["indices"].integer(-1);
+      pr.material = (int32_t) jp["material"].integer(-1);
+      pr.mode     = (uint32_t) jp["mode"].integer(GLTF_MODE_TRIANGLES);
+      validate(pr);
+      m.primitives.push_back(pr);
+    }
+
+    meshes.push_back(std::move(m));
+  }
+}
+
+// Everything packVertices/packIndices will read: attribute shapes, index types and index values
+void AtomicGLTF::Asset::validate(const Primitive &primitive) const
+{
+  auto attribute = [&](int32_t index, uint8_t components, const char *error) {
+    if (index >= (int32_t) accessors.size() || (index >= 0 && accessors[index].components != components))
+      throw std::runtime_error(error);
+  };
+
+  if (primitive.mode > GLTF_MODE_MAX)
+    throw std::runtime_error("invalid glTF primitive mode!");
+
+  attribute(primitive.position, 3, "glTF POSITION accessor is not VEC3!");
+  attribute(primitive.normal,   3, "glTF NORMAL accessor is not VEC3!");
+  attribute(primitive.texcoord, 2, "glTF TEXCOORD_0 accessor is not VEC2!");
+
+  if (primitive.indices < 0) return;
+  if (primitive.indices >= (int32_t) accessors.size())
+    throw std::runtime_error("glTF indices accessor out of range!");
+
+  const Accessor &a = accessors[primitive.indices];
+  if (a.components != 1 || (a.component_type != GLTF_COMPONENT_UNSIGNED_BYTE && a.component_type != GLTF_COMPONENT_UNSIGNED_SHORT && a.component_type != GLTF_COMPONENT_UNSIGNED_INT))
+    throw std::runtime_error("glTF indices accessor is not an unsigned SCALAR!");
+  if (a.count && a.view < 0)
+    throw std::runtime_error("glTF indices accessor has no bufferView!");
+
+  // Every index must name a vertex of this primitive, or the GPU reads past the vertex buffer
+  std::span<const uint8_t> src = data(a);
+  size_t s = stride(a);
+  uint32_t count = vertexCount(primitive);
+
+  for (uint32_t i=0; i<a.count; i++)
+    if (readIndex(a, &src[i*s]) >= count)
+      throw std::runtime_error("glTF index out of range!");
+}
+
+void AtomicGLTF::Asset::release()
+{
+  for (auto &m : mappings) munmap(m.data, m.size);
+  mappings.clear();
+  owned.clear();
+
+  buffers.clear();     views.clear();
+  accessors.clear();   meshes.clear();
+}
+
+std::span<const uint8_t> AtomicGLTF::Asset::map(const std::string &path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("failed to open glTF file: " + path);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    throw std::runtime_error("failed to stat glTF file: " + path);
+  }
+
+  void *data = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) throw std::runtime_error("failed to map glTF file: " + path);
+
+  mappings.push_back({ data, (size_t) st.st_size });
+  return std::span<const uint8_t>((const uint8_t*) data, (size_t) st.st_size);
+}
+
+std::span<const uint8_t> AtomicGLTF::Asset::view(uint32_t index) const
+{
+  const BufferView &v = views.at(index);
+  return buffers[v.buffer].data.subspan(v.offset, v.length);
+}
+
+std::span<const uint8_t> AtomicGLTF::Asset::data(const Accessor &accessor) const
+{
+  if (accessor.view < 0 || !accessor.count) return {};
+  return view(accessor.view).subspan(accessor.offset, stride(accessor) * (accessor.count-1) + elementSize(accessor));
+}
+
+size_t AtomicGLTF::Asset::elementSize(const Accessor &accessor) const
+{
+  size_t component = accessor.component_type == GLTF_COMPONENT_FLOAT || accessor.component_type == GLTF_COMPONENT_UNSIGNED_INT ? 4
+                   : accessor.component_type == GLTF_COMPONENT_SHORT || accessor.component_type == GLTF_COMPONENT_UNSIGNED_SHORT ? 2 : 1;
+  return component * accessor.components;
+}
+
+size_t AtomicGLTF::Asset::stride(const Accessor &accessor) const
+{
+  if (accessor.view >= 0 && views[accessor.view].stride) return views[accessor.view].stride;
+  return elementSize(accessor);
+}
+
+float AtomicGLTF::Asset::readFloat(const Accessor &accessor, const uint8_t *element, uint32_t component) const
+{
+  float v;
+  switch (accessor.component_type)
+  {
+    case GLTF_COMPONENT_FLOAT:          memcpy(&v, element + component*4, 4); return v;
+    case GLTF_COMPONENT_UNSIGNED_BYTE:  v = element[component];  return accessor.normalized ? v / 255.0f : v;
+    case GLTF_COMPONENT_BYTE:           v = (int8_t) element[component]; return accessor.normalized ? std::max(v / 127.0f, -1.0f) : v;
+    case GLTF_COMPONENT_UNSIGNED_SHORT: { uint16_t s; memcpy(&s, element + component*2, 2); return accessor.normalized ? s / 65535.0f : s; }
+    case GLTF_COMPONENT_SHORT:          { int16_t s;  memcpy(&s, element + component*2, 2); return accessor.normalized ? std::max(s / 32767.0f, -1.0f) : s; }
+    default: return 0;
+  }
+}
+
+uint32_t AtomicGLTF::Asset::vertexCount(const Primitive &primitive) const
+{
+  return primitive.position >= 0 ? accessors[primitive.position].count : 0;
+}
+
+uint32_t AtomicGLTF::Asset::indexCount(const Primitive &primitive) const
+{
+  return primitive.indices >= 0 ? accessors[primitive.indices].count : vertexCount(primitive);
+}
+
+void AtomicGLTF::Asset::bounds(const Primitive &primitive, glm::vec3 &min, glm::vec3 &max) const
+{
+  min = max = glm::vec3(0.0f);
+  if (primitive.position < 0) return;
+
+  // Required by the spec for POSITION, and free; integer positions store them unnormalized, so scan those
+  const Accessor &pos = accessors[primitive.position];
+  if (pos.bounded && pos.component_type == GLTF_COMPONENT_FLOAT)
+  {
+    min = glm::vec3(pos.min[0], pos.min[1], pos.min[2]);
+    max = glm::vec3(pos.max[0], pos.max[1], pos.max[2]);
+    return;
+  }
+
+  std::span<const uint8_t> pos_data = data(pos);
+  size_t pos_stride = stride(pos);
+  for (uint32_t i=0; i<pos.count && !pos_data.empty(); i++)
+  {
+    const uint8_t *e = &pos_data[i*pos_stride];
+    glm::vec3 p(readFloat(pos, e, 0), readFloat(pos, e, 1), readFloat(pos, e, 2));
+    min = i ? glm::min(min, p) : p;
+    max = i ? glm::max(max, p) : p;
+  }
+}
+
+template<typename V> uint32_t AtomicGLTF::Asset::packVertices(const Primitive &primitive, const AtomicVertex::Quantization &quantization, V *dst) const
+{
+  if (primitive.position < 0) return 0;
+
+  const Accessor &pos = accessors[primitive.position];
+  std::span<const uint8_t> pos_data = data(pos);
+  size_t pos_stride = stride(pos);
+
+  const Accessor *normal = primitive.normal >= 0 ? &accessors[primitive.normal] : nullptr;
+  std::span<const uint8_t> normal_data = normal ? data(*normal) : std::span<const uint8_t>();
+  size_t normal_stride = normal ? stride(*normal) : 0;
+
+  const Accessor *uv = primitive.texcoord >= 0 ? &accessors[primitive.texcoord] : nullptr;
+  std::span<const uint8_t> uv_data = uv ? data(*uv) : std::span<const uint8_t>();
+  size_t uv_stride = uv ? stride(*uv) : 0;
+
+  for (uint32_t i=0; i<pos.count; i++)
+  {
+    glm::vec3 position(0.0f), norm(0.0f);
+    glm::vec2 texCoord(0.0f);
+    if (!pos_data.empty())
+      position = { readFloat(pos, &pos_data[i*pos_stride], 0), readFloat(pos, &pos_data[i*pos_stride], 1), readFloat(pos, &pos_data[i*pos_stride], 2) };
+    if (!uv_data.empty() && i < uv->count)
+      texCoord = { readFloat(*uv, &uv_data[i*uv_stride], 0), readFloat(*uv, &uv_data[i*uv_stride], 1) };
+    if (!normal_data.empty() && i < normal->count)
+      norm = { readFloat(*normal, &normal_data[i*normal_stride], 0), readFloat(*normal, &normal_data[i*normal_stride], 1), readFloat(*normal, &normal_data[i*normal_stride], 2) };
+
+    // Staging may be write-combined: encode on the stack, then one store
+    V vertex;
+    V::encode(position, norm, texCoord, quantization, vertex);
+    memcpy(dst + i, &vertex, sizeof(V));
+  }
+
+  return pos.count;
+}
+
+uint32_t AtomicGLTF::Asset::packIndices(const Primitive &primitive, uint32_t base_vertex, uint32_t *dst) const
+{
+  // Non-indexed primitive: emit a trivial index list
+  if (primitive.indices < 0)
+  {
+    uint32_t count = vertexCount(primitive);
+    for (uint32_t i=0; i<count; i++) dst[i] = base_vertex + i;
+    return count;
+  }
+
+  const Accessor &a = accessors[primitive.indices];
+  std::span<const uint8_t> src = data(a);
+  size_t s = stride(a);
+
+  // Tightly packed uint32 with no rebase is a straight copy
+  if (a.component_type == GLTF_COMPONENT_UNSIGNED_INT && s == 4 && !base_vertex)
+  {
+    memcpy(dst, src.data(), src.size());
+    return a.count;
+  }
+
+  for (uint32_t i=0; i<a.count; i++)
+    dst[i] = base_vertex + readIndex(a, &src[i*s]);
+
+  return a.count;
+}
+
+uint32_t AtomicGLTF::Asset::readIndex(const Accessor &accessor, const uint8_t *element)
+{
+  uint32_t index = 0;
+  if (accessor.component_type == GLTF_COMPONENT_UNSIGNED_INT)        memcpy(&index, element, 4);
+  else if (accessor.component_type == GLTF_COMPONENT_UNSIGNED_SHORT) { uint16_t v; memcpy(&v, element, 2); index = v; }
+  else                                                               index = *element;
+  return index;
+}
@@ -8,6 +8,24 @@
 #ifndef ATOMICGLTF_H
 #define ATOMICGLTF_H
 
+#include <span>
+#include <strings.h>
+#include <memory>
+
+#define GLTF_GLB_MAGIC              0x46546C67 // "glTF"
+#define GLTF_GLB_CHUNK_JSON         0x4E4F534A
+#define GLTF_GLB_CHUNK_BIN          0x004E4942
+
+#define GLTF_COMPONENT_BYTE            5120
+#define GLTF_COMPONENT_UNSIGNED_BYTE   5121
+#define GLTF_COMPONENT_SHORT           5122
+#define GLTF_COMPONENT_UNSIGNED_SHORT  5123
+#define GLTF_COMPONENT_UNSIGNED_INT    5125
+#define GLTF_COMPONENT_FLOAT           5126
+
+#define GLTF_MODE_TRIANGLES         4
+#define GLTF_MODE_MAX               6          // TRIANGLE_FAN; higher modes are invalid
+
 class AtomicGLTF
 {
  public:
@@ -16,6 +34,7 @@ class AtomicGLTF
 
   AtomicGLTF (AtomicEngine *e) : engine(e)
   {
+    initTimers();
     status = 1;
     printf("Initialized GLTF\n");
   }
@@ -23,6 +42,86 @@ class AtomicGLTF
   void callback();
   void exit();
 
+  AtomicTimer::Handle callback_timer;
+  void initTimers();
+
+  // Minimal JSON DOM, only as much as glTF needs
+  struct Json
+  {
+    enum Type : uint8_t { Null, Bool, Number, String, Array, Object } type = Null;
+    bool boolean = false;         double number = 0;
+    std::string string;           std::vector<Json> array;
+    std::vector<std::pair<std::string, Json>> object;
+
+    const Json& operator[](const char *key) const;
+    const Json& operator[](size_t i) const { static const Json none; return i < array.size() ? array[i] : none; }
+    bool has(const char *key) const { return (*this)[key].type != Null; }
+    size_t size() const { return type == Array ? array.size() : object.size(); }
+
+    int64_t integer(int64_t fallback=0) const { return type == Number ? (int64_t) number : fallback; }
+    const std::string& str() const { return string; }
+
+    static bool parse(const char *&p, const char *end, Json &out);
+  };
+
+  struct Buffer     { std::span<const uint8_t> data; };
+  struct BufferView { uint32_t buffer = 0; size_t offset = 0, length = 0, stride = 0; uint32_t target = 0; };
+  struct Accessor
+  {
+    int32_t  view = -1;           size_t offset = 0;
+    uint32_t component_type = 0;  uint32_t count = 0;
+    uint8_t  components = 1;      bool normalized = false;
+    float    min[3] = {0}, max[3] = {0};  bool bounded = false;  // min/max present
+  };
+  struct Primitive
+  {
+    int32_t position = -1, normal = -1, texcoord = -1, indices = -1, material = -1;
+    uint32_t mode = GLTF_MODE_TRIANGLES;
+  };
+  struct Mesh { std::string name; std::vector<Primitive> primitives; };
+
+  // A loaded .gltf/.glb; buffers are spans into memory-mapped files
+  class Asset
+  {
+   public:
+    std::vector<Buffer> buffers;          std::vector<BufferView> views;
+    std::vector<Accessor> accessors;      std::vector<Mesh> meshes;
+
+    Asset () {}
+    Asset (const Asset&) = delete;
+    Asset& operator= (const Asset&) = delete;
+    ~Asset () { release(); }
+
+    void load(const char *path);
+    void release();
+
+    std::span<const uint8_t> view(uint32_t index) const;
+    std::span<const uint8_t> data(const Accessor &accessor) const;
+    size_t stride(const Accessor &accessor) const;
+    size_t elementSize(const Accessor &accessor) const;
+
+    // Write straight into (mapped staging) memory, no intermediate copies; V is an AtomicVertex layout
+    template<typename V> uint32_t packVertices(const Primitive &primitive, const AtomicVertex::Quantization &quantization, V *dst) const;
+    uint32_t packIndices(const Primitive &primitive, uint32_t base_vertex, uint32_t *dst) const;
+    uint32_t vertexCount(const Primitive &primitive) const;
+    uint32_t indexCount(const Primitive &primitive) const;
+
+    // POSITION bounds: the accessor's min/max for float positions, else a scan of the data
+    void bounds(const Primitive &primitive, glm::vec3 &min, glm::vec3 &max) const;
+
+   private:
+    struct Mapping { void *data; size_t size; };
+    std::vector<Mapping> mappings;        std::vector<std::unique_ptr<uint8_t[]>> owned;
+
+    std::span<const uint8_t> map(const std::string &path);
+    void parse(const Json &json, std::span<const uint8_t> glb_bin, const std::string &base_dir);
+    float readFloat(const Accessor &accessor, const uint8_t *element, uint32_t component) const;
+    static uint32_t readIndex(const Accessor &accessor, const uint8_t *element);
+    void validate(const Primitive &primitive) const;
+  };
+
+  static bool isGLTF(const char *path);
+
  protected:
  private:
 };
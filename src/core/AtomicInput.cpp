@@ -0,0 +1,62 @@
+/**
+ * AtomicInput 0.1
+ */
+
+void AtomicInput::push(EventType type, int code, int action, double x, double y)
+{
+  // GLFW_KEY_UNKNOWN (-1) and out-of-range buttons would index outside the snapshot arrays
+  if (type == Key && (code < 0 || code >= INPUT_KEY_COUNT)) return;
+  if (type == MouseButton && (code < 0 || code >= INPUT_MOUSE_COUNT)) return;
+
+  Event event{AtomicTimer::nowNS(), type, (int8_t) action, (int16_t) code, x, y};
+  if (!ring.push(event)) dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AtomicInput::update()
+{
+  uint32_t back = front.load(std::memory_order_relaxed) ^ 1;
+  Snapshot &next = snapshots[back];
+
+  // Carry state over, reset the per-tick counters
+  next = snapshots[back ^ 1];
+  next.tick++;
+  memset(next.key_presses, 0, sizeof(next.key_presses));
+  memset(next.key_releases, 0, sizeof(next.key_releases));
+  memset(next.mouse_presses, 0, sizeof(next.mouse_presses));
+  memset(next.mouse_releases, 0, sizeof(next.mouse_releases));
+  next.scroll_x = next.scroll_y = 0;
+
+  Event event;
+  while (ring.pop(event))
+  {
+    next.time = event.time;
+
+    switch (event.type)
+    {
+      case Key:
+        next.keys[event.code] = event.action;
+        if (event.action == GLFW_PRESS   && next.key_presses[event.code] < 0xFF)  next.key_presses[event.code]++;
+        if (event.action == GLFW_RELEASE && next.key_releases[event.code] < 0xFF) next.key_releases[event.code]++;
+        break;
+
+      case MouseButton:
+        next.mouse[event.code] = event.action;
+        if (event.action == GLFW_PRESS   && next.mouse_presses[event.code] < 0xFF)  next.mouse_presses[event.code]++;
+        if (event.action == GLFW_RELEASE && next.mouse_releases[event.code] < 0xFF) next.mouse_releases[event.code]++;
+        break;
+
+      case MouseMove:
+        next.mouse_x = event.x;
+        next.mouse_y = event.y;
+        break;
+
+      case Scroll:
+        next.scroll_x += event.x;
+        next.scroll_y += event.y;
+        break;
+    }
+  }
+
+  next.dropped = dropped.load(std::memory_order_relaxed);
+  front.store(back, std::memory_order_release);
+}
@@ -0,0 +1,86 @@
+/**
+ * AtomicInput 0.1
+ *
+ * Window callbacks push timestamped events into a lock-free SPSC ring; the engine
+ * drains it once per tick into double-buffered, read-only input snapshots.
+ */
+
+#ifndef ATOMICINPUT_H
+#define ATOMICINPUT_H
+
+#include <atomic>
+
+#define INPUT_RING_SIZE             1024                          // events, power of two
+#define INPUT_KEY_COUNT             (GLFW_KEY_LAST + 1)
+#define INPUT_MOUSE_COUNT           (GLFW_MOUSE_BUTTON_LAST + 1)
+
+// Single-producer/single-consumer ring; indices on separate cache lines
+template <typename T, size_t N>
+class AtomicSPSC
+{
+  static_assert((N & (N - 1)) == 0, "AtomicSPSC size must be a power of two");
+
+ public:
+  bool push(const T &item)
+  {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == N) return false;
+
+    items[h & (N - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &item)
+  {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+
+    item = items[t & (N - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  alignas(64) std::atomic<size_t> head{0};  // producer
+  alignas(64) std::atomic<size_t> tail{0};  // consumer
+  alignas(64) T items[N];
+};
+
+class AtomicInput
+{
+ public:
+  enum EventType : uint8_t { Key, MouseButton, MouseMove, Scroll };
+
+  struct Event
+  {
+    uint64_t time;                          // AtomicTimer::nowNS()
+    EventType type;                         int8_t action;     int16_t code;
+    double x, y;
+  };
+
+  // Everything the engine reads; counters cover one tick, so presses between polls are never lost
+  struct Snapshot
+  {
+    uint64_t time = 0, tick = 0;            // newest event folded in, update() count
+    int8_t  keys[INPUT_KEY_COUNT] = {0};    uint8_t key_presses[INPUT_KEY_COUNT] = {0},   key_releases[INPUT_KEY_COUNT] = {0};
+    int8_t  mouse[INPUT_MOUSE_COUNT] = {0}; uint8_t mouse_presses[INPUT_MOUSE_COUNT] = {0}, mouse_releases[INPUT_MOUSE_COUNT] = {0};
+    double  mouse_x = 0, mouse_y = 0;       // latest cursor position
+    double  scroll_x = 0, scroll_y = 0;     // accumulated over the tick
+    uint32_t dropped = 0;                   // events lost to a full ring, total
+  };
+
+  // Producer: window callbacks
+  void push(EventType type, int code, int action, double x = 0, double y = 0);
+
+  // Consumer: once per tick
+  void update();
+  const Snapshot& snapshot() const { return snapshots[front.load(std::memory_order_acquire)]; }
+
+ private:
+  AtomicSPSC<Event, INPUT_RING_SIZE> ring;
+  Snapshot snapshots[2];
+  std::atomic<uint32_t> front{0}, dropped{0};
+};
+
+#endif //ATOMICINPUT_H
@@ -0,0 +1,283 @@
+/**
+ * AtomicJobs 0.1
+ */
+
+// Worker identity of the current thread; -1 outside any pool
+static thread_local AtomicJobs *jobs_owner = nullptr;
+static thread_local int jobs_worker = -1;
+
+AtomicJobs::AtomicJobs(unsigned threads)
+{
+  if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (unsigned w = 0; w + 1 < threads; w++)
+    deques.push_back(std::make_unique<Deque>());
+
+  for (unsigned w = 0; w + 1 < threads; w++)
+    workers.emplace_back(&AtomicJobs::workerLoop, this, (int) w);
+}
+
+AtomicJobs::~AtomicJobs()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    stopping = true;
+  }
+  sleep_cv.notify_all();
+
+  for (auto &worker : workers) worker.join();
+
+  // Never-started jobs (e.g. continuations of abandoned counters)
+  for (Job *job : shared) delete job;
+  for (auto &deque : deques)
+    while (Job *job = deque->steal()) delete job;
+}
+
+void AtomicJobs::run(std::function<void()> work, Counter *counter)
+{
+  if (counter) counter->add();
+  submit(new Job{std::move(work), counter});
+}
+
+void AtomicJobs::then(Counter &after, std::function<void()> work, Counter *counter)
+{
+  if (counter) counter->add();
+  Job *job = new Job{std::move(work), counter};
+
+  // The lock orders this against finish(): either we see the drained counter, or it sees our continuation
+  {
+    std::lock_guard<std::mutex> lock(after.mutex);
+    if (after.pending.load(std::memory_order_acquire))
+    {
+      after.continuations.push_back(job);
+      return;
+    }
+  }
+
+  // Drained: let the last finish() leave the counter first, or the continuation could let the caller free it under that call
+  while (after.finishing.load(std::memory_order_acquire)) std::this_thread::yield();
+
+  submit(job);
+}
+
+void AtomicJobs::wait(Counter &counter)
+{
+  uint32_t seed = (uint32_t) (uintptr_t) &counter;
+  int self = jobs_owner == this ? jobs_worker : -1;
+
+  while (!counter.done())
+  {
+    if (Job *job = next(self, seed)) execute(job);
+    else std::this_thread::yield();
+  }
+
+  // Drained, so no job can still be storing an error; clear it so the counter can be reused
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(counter.mutex);
+    error.swap(counter.error);
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+void AtomicJobs::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn)
+{
+  if (!count) return;
+  grain = std::max<size_t>(grain, 1);
+
+  // The submitter holds a reference, so chunks finishing early never drain the counter mid-submission
+  Counter counter;
+  counter.add();
+  for (size_t begin = grain; begin < count; begin += grain)
+    run([&fn, begin, end = std::min(count, begin + grain)] { fn(begin, end); }, &counter);
+
+  // The first chunk runs here, then the caller helps with the rest; queued chunks hold &fn and &counter, so even
+  // a throwing first chunk must wait for them before the frame unwinds
+  try { fn(0, std::min(count, grain)); }
+  catch (...) { counter.fail(std::current_exception()); }
+
+  finish(&counter);
+  wait(counter);
+}
+
+void AtomicJobs::submit(Job *job)
+{
+  queued.fetch_add(1, std::memory_order_release);
+
+  if (jobs_owner == this && jobs_worker >= 0)
+  {
+    if (!deques[jobs_worker]->push(job))
+    {
+      queued.fetch_sub(1, std::memory_order_relaxed);
+      execute(job);
+      return;
+    }
+  }
+  else
+  {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    shared.push_back(job);
+  }
+
+  if (sleepers.load(std::memory_order_acquire))
+  {
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    sleep_cv.notify_one();
+  }
+}
+
+void AtomicJobs::execute(Job *job)
+{
+  // An exception must not leave a worker (std::terminate) or skip finish() (the counter would never drain)
+  try { job->work(); }
+  catch (...)
+  {
+    if (job->counter) job->counter->fail(std::current_exception());
+    else if (ATOMICENGINE_DEBUG) printf("Uncounted job threw; nothing waits on it to report the error\n");
+  }
+
+  finish(job->counter);
+  delete job;
+}
+
+void AtomicJobs::finish(Counter *counter)
+{
+  if (!counter) return;
+
+  // Not the last job: the decrement is the final touch, exactly as if the job had never been counted
+  uint32_t pending = counter->pending.load(std::memory_order_relaxed);
+  while (pending > 1)
+    if (counter->pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) return;
+
+  // Apparently the last: announce the finish() before `pending` can read zero, so done() keeps the counter alive
+  counter->finishing.fetch_add(1, std::memory_order_acq_rel);
+
+  if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+  {
+    // A submission landed in between; our decrement left it outstanding
+    counter->finishing.fetch_sub(1, std::memory_order_release);
+    return;
+  }
+
+  // Last job: then() checks `pending` under the same lock, so every continuation is either here or self-submitted
+  std::vector<Job*> ready;
+  {
+    std::lock_guard<std::mutex> lock(counter->mutex);
+    ready.swap(counter->continuations);
+  }
+
+  // After this the counter may be gone
+  counter->finishing.fetch_sub(1, std::memory_order_release);
+
+  for (Job *job : ready) submit(job);
+}
+
+// Own deque first (LIFO, cache-warm), then the shared queue, then steal from a random victim
+AtomicJobs::Job* AtomicJobs::next(int self, uint32_t &seed)
+{
+  Job *job = nullptr;
+
+  if (self >= 0) job = deques[self]->pop();
+
+  if (!job && queued.load(std::memory_order_acquire))
+  {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    if (!shared.empty())
+    {
+      job = shared.front();
+      shared.pop_front();
+    }
+  }
+
+  for (size_t i = 0; !job && i < deques.size(); i++)
+  {
+    seed = seed * 1664525u + 1013904223u;
+    size_t victim = (seed >> 8) % deques.size();
+    if ((int) victim != self) job = deques[victim]->steal();
+  }
+
+  if (job) queued.fetch_sub(1, std::memory_order_relaxed);
+  return job;
+}
+
+void AtomicJobs::workerLoop(int self)
+{
+  jobs_owner = this;
+  jobs_worker = self;
+  uint32_t seed = 0x9E3779B9u * (self + 1), idle = 0;
+
+  while (!stopping.load(std::memory_order_relaxed))
+  {
+    if (Job *job = next(self, seed))
+    {
+      execute(job);
+      idle = 0;
+      continue;
+    }
+
+    if (++idle < JOBS_SPIN)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Sleep until something is queued; submit() notifies under the same mutex, so no wakeup is lost
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    sleepers.fetch_add(1, std::memory_order_acq_rel);
+    sleep_cv.wait(lock, [this] { return stopping.load() || queued.load(std::memory_order_acquire); });
+    sleepers.fetch_sub(1, std::memory_order_acq_rel);
+    idle = 0;
+  }
+}
+
+bool AtomicJobs::Deque::push(Job *job)
+{
+  int64_t b = bottom.load(std::memory_order_relaxed), t = top.load(std::memory_order_acquire);
+  if (b - t >= JOBS_DEQUE_SIZE) return false;
+
+  items[b & (JOBS_DEQUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom.store(b + 1, std::memory_order_relaxed);
+  return true;
+}
+
+AtomicJobs::Job* AtomicJobs::Deque::pop()
+{
+  int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+  bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t t = top.load(std::memory_order_relaxed);
+
+  if (t > b)
+  {
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  Job *job = items[b & (JOBS_DEQUE_SIZE - 1)].load(std::memory_order_relaxed);
+
+  // Last item: race the thieves for it
+  if (t == b)
+  {
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      job = nullptr;
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  return job;
+}
+
+AtomicJobs::Job* AtomicJobs::Deque::steal()
+{
+  int64_t t = top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t b = bottom.load(std::memory_order_acquire);
+
+  if (t >= b) return nullptr;
+
+  Job *job = items[t & (JOBS_DEQUE_SIZE - 1)].load(std::memory_order_relaxed);
+  if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    return nullptr;
+
+  return job;
+}
@@ -0,0 +1,98 @@
+/**
+ * AtomicJobs 0.1
+ *
+ * Work-stealing job scheduler: one Chase-Lev deque per worker, a shared queue for
+ * submissions from outside the pool, counters to wait on and continuations that
+ * are queued once a counter drains.
+ */
+
+#ifndef ATOMICJOBS_H
+#define ATOMICJOBS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define JOBS_DEQUE_SIZE             4096  // per worker, power of two; a full deque runs the job inline
+#define JOBS_SPIN                   64    // failed steal rounds before a worker sleeps
+
+class AtomicJobs
+{
+ public:
+  struct Job;
+
+  // Outstanding jobs; continuations registered with then() are queued when it reaches zero.
+  // `finishing` counts finish() calls still touching the counter, so waiters may destroy it once both are zero.
+  // The first exception a counted job throws is kept for wait() to rethrow.
+  class Counter
+  {
+    friend class AtomicJobs;
+    std::atomic<uint32_t> pending{0}, finishing{0};
+    std::mutex mutex;
+    std::vector<Job*> continuations;
+    std::exception_ptr error;
+
+    void add() { pending.fetch_add(1, std::memory_order_relaxed); }
+    void fail(std::exception_ptr e) { std::lock_guard<std::mutex> lock(mutex); if (!error) error = e; }
+
+   public:
+    bool done() const { return pending.load(std::memory_order_acquire) == 0 && finishing.load(std::memory_order_acquire) == 0; }
+  };
+
+  struct Job
+  {
+    std::function<void()> work;
+    Counter *counter = nullptr;
+  };
+
+  // threads: total threads working, including the caller of wait(); 0 = hardware cores
+  explicit AtomicJobs(unsigned threads = 0);
+  ~AtomicJobs();
+  AtomicJobs (const AtomicJobs&) = delete;
+  AtomicJobs& operator= (const AtomicJobs&) = delete;
+
+  void run(std::function<void()> work, Counter *counter = nullptr);
+  void then(Counter &after, std::function<void()> work, Counter *counter = nullptr);
+
+  // Runs queued jobs on the calling thread until the counter drains, then rethrows the first job exception
+  void wait(Counter &counter);
+
+  // fn(begin, end) over [0, count) in chunks of at most `grain`; every chunk has finished when it returns or throws
+  void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+  unsigned threads() const { return (unsigned) workers.size() + 1; }
+
+ private:
+  // Chase-Lev deque (Le et al. 2013): the owner pushes/pops the bottom, thieves take the top
+  struct Deque
+  {
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    alignas(64) std::atomic<Job*> items[JOBS_DEQUE_SIZE];
+
+    bool push(Job *job);
+    Job* pop();
+    Job* steal();
+  };
+
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<Deque>> deques;  // [worker]
+  std::deque<Job*> shared;                     // submissions from non-worker threads
+  std::mutex shared_mutex, sleep_mutex;
+  std::condition_variable sleep_cv;
+  std::atomic<uint32_t> queued{0}, sleepers{0};
+  std::atomic<bool> stopping{false};
+
+  void submit(Job *job);
+  void execute(Job *job);
+  void finish(Counter *counter);
+  Job* next(int self, uint32_t &seed);
+  void workerLoop(int self);
+};
+
+#endif //ATOMICJOBS_H
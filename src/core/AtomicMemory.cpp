@@ -0,0 +1,250 @@
+/**
+ * AtomicMemory 0.1
+ */
+
+void AtomicMemory::init(VkPhysicalDevice physical_device, VkDevice d)
+{
+  device = d;
+  vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  granularity = properties.limits.bufferImageGranularity;
+
+  pools.assign(memory_properties.memoryTypeCount * 2, Pool());
+  dedicated_stats.assign(memory_properties.memoryHeapCount, HeapStats());
+
+  for (uint32_t type = 0; type < memory_properties.memoryTypeCount; type++)
+  {
+    // Blocks never exceed 1/8th of their heap, so small heaps (e.g. BAR) aren't hoarded
+    VkDeviceSize heap = memory_properties.memoryHeaps[memory_properties.memoryTypes[type].heapIndex].size,
+                 size = MEMORY_BLOCK_SIZE;
+    while (size > (1ull << MEMORY_MIN_ORDER) && size > heap / 8) size >>= 1;
+
+    for (uint32_t linear = 0; linear < 2; linear++)
+    {
+      Pool &pool = pools[type * 2 + linear];
+      pool.memory_type = type;
+      pool.linear = linear;
+      pool.block_order = orderOf(size);
+    }
+  }
+}
+
+void AtomicMemory::destroy()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (ATOMICENGINE_DEBUG)
+    for (auto &pool : pools)
+      for (auto &block : pool.blocks)
+        if (block.allocations)
+          printf("Memory leak: type %u, %u allocations (%llu bytes) still live\n", pool.memory_type, block.allocations, (unsigned long long) block.used);
+
+  for (auto &pool : pools)
+  {
+    for (auto &block : pool.blocks)
+      if (block.memory) vkFreeMemory(device, block.memory, nullptr);
+    pool.blocks.clear();
+  }
+}
+
+AtomicMemory::Allocation AtomicMemory::allocate(const VkMemoryRequirements &requirements, uint32_t memory_type, bool linear)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  Allocation out;
+
+  // Buddies are aligned to their own size; once they can't share a granularity page, one pool serves both
+  if (granularity <= (1ull << MEMORY_MIN_ORDER)) linear = true;
+
+  Pool &pool = pools[memory_type * 2 + linear];
+  uint8_t order = orderOf(std::max(requirements.size, requirements.alignment));
+
+  // Larger than a block: dedicated allocation
+  if (order > pool.block_order)
+  {
+    out.memory = allocateMemory(requirements.size, memory_type, &out.mapped);
+    out.size = requirements.size;
+    out.pool = memory_type * 2 + linear;
+    out.dedicated = true;
+
+    HeapStats &heap = dedicated_stats[memory_properties.memoryTypes[memory_type].heapIndex];
+    heap.dedicated++;
+    heap.dedicated_bytes += out.size;
+    return out;
+  }
+
+  out.pool = memory_type * 2 + linear;
+
+  for (uint32_t b = 0; b < pool.blocks.size(); b++)
+    if (pool.blocks[b].memory && allocateFrom(pool, b, order, out))
+      return out;
+
+  // New block, reusing a released slot if there is one
+  uint32_t b = 0;
+  while (b < pool.blocks.size() && pool.blocks[b].memory) b++;
+  if (b == pool.blocks.size()) pool.blocks.emplace_back();
+
+  if (!createBlock(pool, pool.blocks[b]) || !allocateFrom(pool, b, order, out))
+    throw std::runtime_error("failed to allocate memory block!");
+
+  return out;
+}
+
+void AtomicMemory::free(Allocation &allocation)
+{
+  if (!allocation.memory) return;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (allocation.dedicated)
+  {
+    HeapStats &heap = dedicated_stats[memory_properties.memoryTypes[pools[allocation.pool].memory_type].heapIndex];
+    heap.dedicated--;
+    heap.dedicated_bytes -= allocation.size;
+
+    vkFreeMemory(device, allocation.memory, nullptr);
+    allocation = Allocation();
+    return;
+  }
+
+  Pool &pool = pools[allocation.pool];
+  Block &block = pool.blocks[allocation.block];
+
+  // Merge with free buddies upwards
+  VkDeviceSize offset = allocation.offset;
+  uint8_t order = allocation.order;
+  for (; order < pool.block_order; order++)
+  {
+    auto buddy = block.free_lists[order].find(offset ^ (1ull << order));
+    if (buddy == block.free_lists[order].end()) break;
+
+    block.free_lists[order].erase(buddy);
+    offset &= ~(1ull << order);
+  }
+  block.free_lists[order].insert(offset);
+
+  block.used -= 1ull << allocation.order;
+  block.allocations--;
+
+  // Keep the first block around; release other blocks once they empty out
+  if (!block.allocations && allocation.block > 0)
+  {
+    vkFreeMemory(device, block.memory, nullptr);
+    block = Block();
+  }
+
+  allocation = Allocation();
+}
+
+std::vector<AtomicMemory::HeapStats> AtomicMemory::stats()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<HeapStats> heaps = dedicated_stats;
+
+  for (uint32_t h = 0; h < heaps.size(); h++)
+    heaps[h].heap_size = memory_properties.memoryHeaps[h].size;
+
+  for (auto &pool : pools)
+  {
+    HeapStats &heap = heaps[memory_properties.memoryTypes[pool.memory_type].heapIndex];
+
+    for (auto &block : pool.blocks)
+    {
+      if (!block.memory) continue;
+      heap.blocks++;
+      heap.block_bytes += 1ull << pool.block_order;
+      heap.used_bytes  += block.used;
+      heap.allocations += block.allocations;
+    }
+  }
+
+  return heaps;
+}
+
+void AtomicMemory::printStats()
+{
+  auto heaps = stats();
+
+  for (uint32_t h = 0; h < heaps.size(); h++)
+  {
+    const HeapStats &heap = heaps[h];
+    if (!heap.blocks && !heap.dedicated) continue;
+
+    printf("Heap %u (%s, %llu MB): %u blocks, %.2f / %.2f MB used by %u allocations, %u dedicated (%.2f MB)\n",
+           h, memory_properties.memoryHeaps[h].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ? "device" : "host",
+           (unsigned long long) (heap.heap_size >> 20), heap.blocks,
+           heap.used_bytes / 1048576.0, heap.block_bytes / 1048576.0, heap.allocations,
+           heap.dedicated, heap.dedicated_bytes / 1048576.0);
+  }
+}
+
+bool AtomicMemory::createBlock(Pool &pool, Block &block)
+{
+  void *mapped = nullptr;
+  block.memory = allocateMemory(1ull << pool.block_order, pool.memory_type, &mapped);
+  block.mapped = (uint8_t*) mapped;
+  block.used = 0;
+  block.allocations = 0;
+
+  block.free_lists.assign(pool.block_order + 1, std::set<VkDeviceSize>());
+  block.free_lists[pool.block_order].insert(0);
+
+  return block.memory != VK_NULL_HANDLE;
+}
+
+bool AtomicMemory::allocateFrom(Pool &pool, uint32_t block_index, uint8_t order, Allocation &out)
+{
+  Block &block = pool.blocks[block_index];
+
+  // Smallest free buddy that fits, split down to the requested order
+  uint8_t o = order;
+  while (o <= pool.block_order && block.free_lists[o].empty()) o++;
+  if (o > pool.block_order) return false;
+
+  VkDeviceSize offset = *block.free_lists[o].begin();
+  block.free_lists[o].erase(block.free_lists[o].begin());
+
+  while (o > order)
+  {
+    o--;
+    block.free_lists[o].insert(offset + (1ull << o));
+  }
+
+  block.used += 1ull << order;
+  block.allocations++;
+
+  out.memory = block.memory;
+  out.offset = offset;
+  out.size   = 1ull << order;
+  out.mapped = block.mapped ? block.mapped + offset : nullptr;
+  out.block  = block_index;
+  out.order  = order;
+  return true;
+}
+
+VkDeviceMemory AtomicMemory::allocateMemory(VkDeviceSize size, uint32_t memory_type, void **mapped)
+{
+  VkMemoryAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.allocationSize = size;
+  allocInfo.memoryTypeIndex = memory_type;
+
+  VkDeviceMemory memory;
+  if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+    throw std::runtime_error("failed to allocate device memory!");
+
+  // Host-visible memory stays mapped for its whole lifetime
+  *mapped = nullptr;
+  if (memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mapped);
+
+  return memory;
+}
+
+uint8_t AtomicMemory::orderOf(VkDeviceSize size)
+{
+  uint8_t order = MEMORY_MIN_ORDER;
+  while ((1ull << order) < size) order++;
+  return order;
+}
@@ -0,0 +1,78 @@
+/**
+ * AtomicMemory 0.1
+ *
+ * Device memory sub-allocator: large blocks per memory type, buddy placement
+ * inside each block, host-visible blocks persistently mapped.
+ */
+
+#ifndef ATOMICMEMORY_H
+#define ATOMICMEMORY_H
+
+#include <vulkan/vulkan.h>
+#include <mutex>
+#include <set>
+
+#define MEMORY_BLOCK_SIZE           (64ull << 20) // preferred block size, shrunk for small heaps
+#define MEMORY_MIN_ORDER            8             // smallest buddy: 256 bytes
+
+class AtomicMemory
+{
+ public:
+  struct Allocation
+  {
+    VkDeviceMemory memory = VK_NULL_HANDLE; VkDeviceSize offset = 0, size = 0;
+    void *mapped = nullptr;                 // host-visible only
+    uint32_t pool = 0, block = 0;           uint8_t order = 0;  bool dedicated = false;
+
+    explicit operator bool() const { return memory != VK_NULL_HANDLE; }
+  };
+
+  struct HeapStats
+  {
+    VkDeviceSize heap_size = 0, block_bytes = 0, used_bytes = 0, dedicated_bytes = 0;
+    uint32_t blocks = 0, allocations = 0, dedicated = 0;
+  };
+
+  AtomicMemory () {}
+  AtomicMemory (const AtomicMemory&) = delete;
+  AtomicMemory& operator= (const AtomicMemory&) = delete;
+
+  void init(VkPhysicalDevice physical_device, VkDevice device);
+  void destroy();
+
+  // linear: buffers and linear images; optimal-tiling images live in separate blocks (bufferImageGranularity)
+  Allocation allocate(const VkMemoryRequirements &requirements, uint32_t memory_type, bool linear);
+  void free(Allocation &allocation);
+
+  std::vector<HeapStats> stats();
+  void printStats();
+
+ private:
+  struct Block
+  {
+    VkDeviceMemory memory = VK_NULL_HANDLE; uint8_t *mapped = nullptr;
+    VkDeviceSize used = 0;                  uint32_t allocations = 0;
+    std::vector<std::set<VkDeviceSize>> free_lists;  // per order, offsets of free buddies
+  };
+
+  struct Pool
+  {
+    uint32_t memory_type = 0;               bool linear = true;
+    uint8_t block_order = 0;                std::vector<Block> blocks;
+  };
+
+  VkDevice device = VK_NULL_HANDLE;
+  VkPhysicalDeviceMemoryProperties memory_properties{};
+  VkDeviceSize granularity = 1;
+  std::vector<Pool> pools;                  // [memory_type * 2 + linear]
+  std::vector<HeapStats> dedicated_stats;   // per heap, dedicated allocations only
+  std::mutex mutex;
+
+  bool createBlock(Pool &pool, Block &block);
+  bool allocateFrom(Pool &pool, uint32_t block_index, uint8_t order, Allocation &out);
+  VkDeviceMemory allocateMemory(VkDeviceSize size, uint32_t memory_type, void **mapped);
+
+  static uint8_t orderOf(VkDeviceSize size);
+};
+
+#endif //ATOMICMEMORY_H
@@ -0,0 +1,271 @@
+/**
+ * AtomicMesh 0.1
+ */
+
+void AtomicMesh::assign(const void *vertex_data, uint32_t vcount, uint32_t vstride, const uint32_t *index_data, uint32_t icount)
+{
+  release();
+
+  vertices = vertex_data;   vertex_count = vcount;   vertex_stride = vstride;
+  indices  = index_data;    index_count  = icount;
+}
+
+bool AtomicMesh::loadCache(const char *source, uint32_t stride)
+{
+  release();
+
+  uint64_t source_size;
+  int64_t source_mtime;
+  if (!sourceStat(source, source_size, source_mtime))
+    return false;
+
+  int fd = open(cachePath(source).c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CacheHeader))
+  {
+    close(fd);
+    return false;
+  }
+
+  void *map = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return false;
+
+  // Validate: format, vertex layout and source identity (path, size, mtime)
+  const CacheHeader *header = (const CacheHeader*) map;
+  uint64_t vertex_bytes = (uint64_t) header->vertex_count * stride,
+           index_bytes  = (uint64_t) header->index_count * sizeof(uint32_t);
+
+  if (header->magic != MESH_CACHE_MAGIC || header->version != MESH_CACHE_VERSION
+      || header->vertex_stride != stride || header->index_stride != sizeof(uint32_t)
+      || header->source_hash != hashPath(source)
+      || header->source_size != source_size || header->source_mtime != source_mtime
+      || header->vertex_offset + vertex_bytes > (uint64_t) st.st_size
+      || header->index_offset + index_bytes > (uint64_t) st.st_size)
+  {
+    munmap(map, (size_t) st.st_size);
+    return false;
+  }
+
+  madvise(map, (size_t) st.st_size, MADV_SEQUENTIAL);
+
+  mapping = map;
+  mapping_size = (size_t) st.st_size;
+
+  vertices = (const char*) map + header->vertex_offset;
+  indices  = (const uint32_t*) ((const char*) map + header->index_offset);
+  vertex_count  = header->vertex_count;
+  vertex_stride = stride;
+  index_count   = header->index_count;
+
+  if (ATOMICENGINE_DEBUG)
+    printf("Mesh cache hit: %s (%u vertices, %u indices)\n", source, vertex_count, index_count);
+
+  return true;
+}
+
+bool AtomicMesh::storeCache(const char *source) const
+{
+  if (!vertices || !indices) return false;
+
+  CacheHeader header{};
+  header.magic         = MESH_CACHE_MAGIC;
+  header.version       = MESH_CACHE_VERSION;
+  header.vertex_stride = vertex_stride;
+  header.index_stride  = sizeof(uint32_t);
+  header.source_hash   = hashPath(source);
+  header.vertex_count  = vertex_count;
+  header.index_count   = index_count;
+  header.vertex_offset = alignUp(sizeof(CacheHeader), 16);
+  header.index_offset  = alignUp(header.vertex_offset + (uint64_t) vertex_count * vertex_stride, 16);
+
+  if (!sourceStat(source, header.source_size, header.source_mtime))
+    return false;
+
+  return atomicengine_write_file(cachePath(source), [&](std::ofstream &file)
+  {
+    static const char padding[16] = {0};
+    file.write((const char*) &header, sizeof(header));
+    file.write(padding, header.vertex_offset - sizeof(header));
+    file.write((const char*) vertices, (std::streamsize) vertex_count * vertex_stride);
+    file.write(padding, header.index_offset - (header.vertex_offset + (uint64_t) vertex_count * vertex_stride));
+    file.write((const char*) indices, (std::streamsize) index_count * sizeof(uint32_t));
+  });
+}
+
+void AtomicMesh::release()
+{
+  if (mapping) munmap(mapping, mapping_size);
+  mapping = nullptr;
+  mapping_size = 0;
+
+  vertices = nullptr;   vertex_count = vertex_stride = 0;
+  indices  = nullptr;   index_count  = 0;
+
+  write_vertices = nullptr;
+  write_indices  = nullptr;
+}
+
+bool AtomicMesh::sourceStat(const char *source, uint64_t &size, int64_t &mtime)
+{
+  struct stat st;
+  if (stat(source, &st) != 0) return false;
+
+  size = (uint64_t) st.st_size;
+#ifdef __APPLE__
+  mtime = (int64_t) st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+  mtime = (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+
+  return true;
+}
+
+// 64-bit MurmurHash3-style mix over 8-byte lanes
+uint64_t AtomicMesh::hashBytes(const void *data, size_t len)
+{
+  auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+  auto lane = [&](uint64_t k) { k *= 0x87C37B91114253D5ull; k = rotl(k, 31); return k * 0x4CF5AD432745937Full; };
+
+  const uint8_t *p = (const uint8_t*) data;
+  uint64_t h = 0x9E3779B97F4A7C15ull ^ len;
+
+  for (size_t n = len >> 3; n--; p += 8)
+  {
+    uint64_t k;
+    memcpy(&k, p, 8);
+    h ^= lane(k);
+    h = rotl(h, 27) * 5 + 0x52DCE729;
+  }
+
+  if (len & 7)
+  {
+    uint64_t k = 0;
+    memcpy(&k, p, len & 7);
+    h ^= lane(k);
+  }
+
+  h ^= h >> 33;  h *= 0xFF51AFD7ED558CCDull;
+  h ^= h >> 33;  h *= 0xC4CEB9FE1A85EC53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+template<typename Key> void AtomicMesh::Welder<Key>::reserve(size_t expected)
+{
+  size_t capacity = 16;
+  while (capacity < expected * 2) capacity <<= 1;
+
+  keys.reserve(expected);
+  if (capacity > slots.size()) rehash(capacity);
+}
+
+template<typename Key> void AtomicMesh::Welder<Key>::rehash(size_t capacity)
+{
+  slots.assign(capacity, Slot{0, 0});
+  mask = capacity - 1;
+
+  for (uint32_t i = 0; i < keys.size(); i++)
+  {
+    uint64_t h = hashBytes(&keys[i], sizeof(Key));
+    size_t s = h & mask;
+    while (slots[s].tag) s = (s + 1) & mask;
+    slots[s] = { (uint32_t) (h >> 32) | 1, i };
+  }
+}
+
+template<typename Key> uint32_t AtomicMesh::Welder<Key>::weld(const Key &key)
+{
+  // Keep load factor under 3/4
+  if ((keys.size() + 1) * 4 > slots.size() * 3)
+    rehash(slots.size() * 2);
+
+  uint64_t h = hashBytes(&key, sizeof(Key));
+  uint32_t tag = (uint32_t) (h >> 32) | 1;
+
+  for (size_t s = h & mask;; s = (s + 1) & mask)
+  {
+    Slot &slot = slots[s];
+
+    if (!slot.tag)
+    {
+      slot = { tag, (uint32_t) keys.size() };
+      keys.push_back(key);
+      return slot.value;
+    }
+
+    if (slot.tag == tag && memcmp(&keys[slot.value], &key, sizeof(Key)) == 0)
+      return slot.value;
+  }
+}
+
+template<typename Key, typename Vertex, typename Make>
+void AtomicMesh::weldParallel(AtomicJobs &jobs, const std::vector<std::span<const Key>> &chunks, Make make, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+  struct Local { std::vector<Vertex> vertices; std::vector<uint32_t> indices, remap; size_t offset = 0; };
+  std::vector<Local> locals(chunks.size());
+
+  // Local weld: key tuples first, then identical vertex bytes
+  jobs.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; c++)
+    {
+      Local &local = locals[c];
+      Welder<Key> keys(chunks[c].size());
+
+      local.indices.resize(chunks[c].size());
+      for (size_t i = 0; i < chunks[c].size(); i++)
+        local.indices[i] = keys.weld(chunks[c][i]);
+
+      Welder<Vertex> unique(keys.unique().size());
+      std::vector<uint32_t> remap(keys.unique().size());
+      for (size_t i = 0; i < remap.size(); i++)
+        remap[i] = unique.weld(make(keys.unique()[i]));
+
+      for (auto &index : local.indices) index = remap[index];
+      local.vertices = unique.take();
+    }
+  });
+
+  // Merge: local vertices in chunk order keep global first-appearance order
+  size_t index_total = 0, vertex_total = 0;
+  for (auto &local : locals)
+  {
+    local.offset = index_total;
+    index_total  += local.indices.size();
+    vertex_total += local.vertices.size();
+  }
+
+  Welder<Vertex> global(vertex_total);
+  for (auto &local : locals)
+  {
+    local.remap.resize(local.vertices.size());
+    for (size_t i = 0; i < local.vertices.size(); i++)
+      local.remap[i] = global.weld(local.vertices[i]);
+    std::vector<Vertex>().swap(local.vertices);
+  }
+
+  // Rewrite indices into their final ranges
+  indices.resize(index_total);
+  jobs.parallelFor(locals.size(), 1, [&](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; c++)
+    {
+      const Local &local = locals[c];
+      for (size_t i = 0; i < local.indices.size(); i++)
+        indices[local.offset + i] = local.remap[local.indices[i]];
+    }
+  });
+
+  vertices = global.take();
+}
+
+uint64_t AtomicMesh::hashPath(const char *source)
+{
+  uint64_t h = 0xCBF29CE484222325ull;
+  for (const char *c = source; *c; c++)
+    h = (h ^ (uint8_t) *c) * 0x100000001B3ull;
+  return h;
+}
@@ -0,0 +1,100 @@
+/**
+ * AtomicMesh 0.1
+ *
+ * Welded mesh data (vertices + uint32 indices), either owned by the caller or
+ * memory-mapped from a versioned binary cache written next to the source asset.
+ */
+
+#ifndef ATOMICMESH_H
+#define ATOMICMESH_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <functional>
+#include <span>
+
+#define MESH_CACHE_MAGIC            0x434D4541 // "AEMC"
+#define MESH_CACHE_VERSION          4
+#define MESH_CACHE_EXTENSION        ".aemesh"
+#define MESH_WELD_CHUNK_MIN         0x10000    // indices per parallel weld chunk, at least
+
+class AtomicMesh
+{
+ public:
+  const void     *vertices = nullptr;   uint32_t vertex_count = 0, vertex_stride = 0;
+  const uint32_t *indices  = nullptr;   uint32_t index_count = 0;
+
+  // Optional writers for sources packed straight into the destination (e.g. glTF accessor spans)
+  std::function<void(void*)> write_vertices, write_indices;
+
+  AtomicMesh () {}
+  AtomicMesh (const AtomicMesh&) = delete;
+  AtomicMesh& operator= (const AtomicMesh&) = delete;
+  ~AtomicMesh () { release(); }
+
+  // Point the view at caller-owned data
+  void assign(const void *vertex_data, uint32_t vertex_count, uint32_t vertex_stride, const uint32_t *index_data, uint32_t index_count);
+
+  // Fill staging memory (vertex_count * vertex_stride / index_count * 4 bytes)
+  void copyVertices(void *dst) const { if (write_vertices) write_vertices(dst); else memcpy(dst, vertices, (size_t) vertex_count * vertex_stride); }
+  void copyIndices(void *dst) const  { if (write_indices) write_indices(dst);   else memcpy(dst, indices, (size_t) index_count * sizeof(uint32_t)); }
+
+  // Cache: map on hit, write after a cold load
+  bool loadCache(const char *source, uint32_t vertex_stride);
+  bool storeCache(const char *source) const;
+
+  void release();
+  bool isMapped() const { return mapping != nullptr; }
+
+  static std::string cachePath(const char *source) { return std::string(source) + MESH_CACHE_EXTENSION; }
+
+  // tinyobj (vertex, texcoord, normal) index tuple, a cheap exact welding key
+  struct ObjIndex { int32_t vertex, texcoord, normal; };
+
+  // Flat open-addressing welder: linear probing over 8-byte slots, keys compared bytewise
+  template<typename Key> class Welder
+  {
+   public:
+    explicit Welder (size_t expected=0) { reserve(expected); }
+
+    void reserve(size_t expected);
+    uint32_t weld(const Key &key);                 // index of key, appended on first sight
+    const std::vector<Key>& unique() const { return keys; }
+    std::vector<Key> take() { slots.clear(); mask = 0; return std::move(keys); }
+
+   private:
+    struct Slot { uint32_t tag, value; };         // tag 0 = empty
+    std::vector<Slot> slots;                      std::vector<Key> keys;
+    size_t mask = 0;
+
+    void rehash(size_t capacity);
+  };
+
+  static uint64_t hashBytes(const void *data, size_t len);
+  static bool sourceStat(const char *source, uint64_t &size, int64_t &mtime);  // size and mtime (ns), for cache validation
+
+  // Weld chunks of keys on the job pool, then merge in chunk order (same output as a serial weld)
+  template<typename Key, typename Vertex, typename Make>
+  static void weldParallel(AtomicJobs &jobs, const std::vector<std::span<const Key>> &chunks, Make make, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+ private:
+  // On-disk layout: header, vertex array, index array (each 16-byte aligned)
+  struct CacheHeader
+  {
+    uint32_t magic, version;
+    uint32_t vertex_stride, index_stride;
+    uint64_t source_hash;        // FNV-1a of the source path
+    uint64_t source_size;
+    int64_t  source_mtime;       // nanoseconds
+    uint32_t vertex_count, index_count;
+    uint64_t vertex_offset, index_offset;
+  };
+
+  void *mapping = nullptr;      size_t mapping_size = 0;
+
+  static uint64_t hashPath(const char *source);
+  static uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) & ~(a - 1); }
+};
+
+#endif //ATOMICMESH_H
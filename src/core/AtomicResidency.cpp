@@ -0,0 +1,104 @@
+/**
+ * AtomicResidency 0.1
+ */
+
+uint32_t AtomicResidency::add(const std::string &path)
+{
+  Texture texture;
+  texture.path = path;
+  textures.push_back(texture);
+  return (uint32_t) textures.size() - 1;
+}
+
+void AtomicResidency::update(double dt, std::vector<Request> &requests)
+{
+  clock += dt;
+
+  for (Texture &t : textures)
+  {
+    t.min_lod = std::max(0.0f, t.min_lod - (float) dt * TEXTURE_STREAM_FADE_RATE);
+    if (!t.levels) continue;
+
+    // Texels across the texture vs pixels across its largest user: one level per halving
+    uint32_t tail = tailLevel(t), wanted = tail;
+    if (t.screen > 0.0f)
+    {
+      float level = std::floor(std::log2(std::max(t.width, t.height) / t.screen) + TEXTURE_STREAM_LOD_BIAS);
+      wanted = (uint32_t) std::clamp(level, 0.0f, (float) tail);
+    }
+
+    // Finer at once; coarser only once it has wanted less for a while
+    if (wanted <= t.resident) t.finer_at = clock;
+    t.target = wanted <= t.resident || clock - t.finer_at >= TEXTURE_STREAM_EVICT_DELAY ? wanted : t.resident;
+  }
+
+  // Over budget: a level at a time, take from whichever spends the most bytes per pixel it covers (off-screen first)
+  uint64_t total = 0;
+  for (const Texture &t : textures) if (t.levels) total += estimate(t, t.target);
+
+  while (total > TEXTURE_STREAM_BUDGET)
+  {
+    Texture *victim = nullptr;
+    double victim_density = 0.0;
+    for (Texture &t : textures)
+    {
+      if (!t.levels || t.target >= tailLevel(t)) continue;
+
+      double density = estimate(t, t.target) / std::max(1.0, (double) t.screen * t.screen);
+      if (!victim || density > victim_density) victim = &t, victim_density = density;
+    }
+    if (!victim) break;
+
+    total -= estimate(*victim, victim->target) - estimate(*victim, victim->target + 1);
+    victim->target++;
+  }
+
+  for (uint32_t id = 0; id < textures.size(); id++)
+  {
+    Texture &t = textures[id];
+    t.screen = 0.0f;
+
+    if (t.loading) continue;
+    if (!t.levels) requests.push_back({id, TEXTURE_STREAM_TAIL_EXTENT});
+    else if (t.target != t.resident) requests.push_back({id, extent(t, t.target)});
+    else continue;
+
+    t.loading = true;
+  }
+}
+
+void AtomicResidency::resident(uint32_t id, uint32_t first, uint32_t width, uint32_t height, uint32_t levels, uint64_t bytes)
+{
+  Texture &t = textures[id];
+
+  // Start the new image where the old one was: a finer image fades in, a coarser one drops the clamp it no longer needs
+  if (t.resident != ~0u) t.min_lod = std::max(0.0f, t.min_lod + (float) t.resident - (float) first);
+
+  t.width = width;
+  t.height = height;
+  t.levels = levels;
+  t.resident = first;
+  t.bytes = bytes;
+  t.loading = false;
+}
+
+uint64_t AtomicResidency::residentBytes() const
+{
+  uint64_t total = 0;
+  for (const Texture &t : textures) total += t.bytes;
+  return total;
+}
+
+uint32_t AtomicResidency::tailLevel(const Texture &t)
+{
+  uint32_t level = 0;
+  while (level + 1 < t.levels && extent(t, level) > TEXTURE_STREAM_TAIL_EXTENT) level++;
+  return level;
+}
+
+// Scaled from the resident image: each finer level roughly quadruples it
+uint64_t AtomicResidency::estimate(const Texture &t, uint32_t level)
+{
+  if (t.resident == ~0u) return 0;
+  return level >= t.resident ? t.bytes >> (2 * (level - t.resident)) : t.bytes << (2 * (t.resident - level));
+}
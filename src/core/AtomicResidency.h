@@ -0,0 +1,72 @@
+/**
+ * AtomicResidency 0.1
+ *
+ * Mip streaming policy. Each streamed texture starts with only its tail levels
+ * resident; every frame the largest on-screen size of its visible users picks
+ * the finest level it needs, and the targets are coarsened (most bytes per covered
+ * pixel first) until they fit the VRAM budget. A texture whose target differs from
+ * what is resident gets a new image with exactly the levels it needs. The
+ * shader clamps sampling with a per-texture min LOD that starts where the old
+ * image was and eases down, so residency changes never pop or rebuild samplers.
+ */
+
+#ifndef ATOMICRESIDENCY_H
+#define ATOMICRESIDENCY_H
+
+#define TEXTURE_STREAM_BUDGET       (128ull << 20) // resident bytes across all streamed textures
+#define TEXTURE_STREAM_TAIL_EXTENT  64             // largest level loaded up front, and never evicted
+#define TEXTURE_STREAM_LOD_BIAS     0.0f           // added to the level the on-screen size asks for
+#define TEXTURE_STREAM_FADE_RATE    4.0f           // levels per second a finer image blends in at
+#define TEXTURE_STREAM_EVICT_DELAY  2.0            // seconds a texture must want fewer levels before it loses them
+
+class AtomicResidency
+{
+ public:
+  struct Texture
+  {
+    std::string path;
+    uint32_t width = 0, height = 0, levels = 0;  // full chain; known once the tail is resident
+    uint32_t resident = ~0u;                      // chain level at the current image's level 0 (~0u: nothing yet)
+    bool loading = false;                         // one load in flight at a time
+    uint32_t target = ~0u;                        // first level wanted this frame
+    uint64_t bytes = 0;                           // current image
+    float min_lod = 0.0f;                         // in the current image's levels
+    float screen = 0.0f;                          // largest on-screen extent (pixels) of a user this frame
+    double finer_at = 0.0;                        // last time it wanted at least the resident levels
+  };
+
+  struct Request { uint32_t texture; uint32_t max_extent; };
+
+  AtomicResidency () {}
+  AtomicResidency (const AtomicResidency&) = delete;
+  AtomicResidency& operator= (const AtomicResidency&) = delete;
+
+  uint32_t add(const std::string &path);
+  const Texture& texture(uint32_t id) const { return textures[id]; }
+  size_t size() const { return textures.size(); }
+
+  // On-screen extent of one visible user, in pixels
+  void observe(uint32_t id, float pixels) { if (id < textures.size()) textures[id].screen = std::max(textures[id].screen, pixels); }
+
+  // Targets for this frame's observations, under the budget; appends the loads to issue (one in flight per texture)
+  void update(double dt, std::vector<Request> &requests);
+
+  // A load finished: `first` is the chain level at the new image's level 0
+  void resident(uint32_t id, uint32_t first, uint32_t width, uint32_t height, uint32_t levels, uint64_t bytes);
+
+  // A load that will not land: the texture keeps what it has and may ask again
+  void cancel(uint32_t id) { if (id < textures.size()) textures[id].loading = false; }
+
+  float minLod(uint32_t id) const { return id < textures.size() ? textures[id].min_lod : 0.0f; }
+  uint64_t residentBytes() const;
+
+ private:
+  std::vector<Texture> textures;
+  double clock = 0.0;
+
+  static uint32_t tailLevel(const Texture &t);
+  static uint32_t extent(const Texture &t, uint32_t level) { return std::max(1u, std::max(t.width, t.height) >> level); }
+  static uint64_t estimate(const Texture &t, uint32_t level);
+};
+
+#endif //ATOMICRESIDENCY_H
@@ -0,0 +1,93 @@
+/**
+ * AtomicScene 0.1
+ */
+
+void AtomicScene::clear()
+{
+  meshes.clear();
+  vertex_total = index_total = 0;
+}
+
+uint32_t AtomicScene::addMesh(uint32_t vertex_count, uint32_t index_count, const glm::vec3 &min, const glm::vec3 &max, const AtomicVertex::Quantization &quantization)
+{
+  Mesh mesh;
+  mesh.first_index = index_total;
+  mesh.index_count = index_count;
+  mesh.vertex_offset = (int32_t) vertex_total;
+  mesh.min = min;
+  mesh.max = max;
+  mesh.quantization = quantization;
+
+  vertex_total += vertex_count;
+  index_total += index_count;
+
+  meshes.push_back(mesh);
+  return (uint32_t) meshes.size() - 1;
+}
+
+void AtomicScene::packMeshes(MeshData *dst) const
+{
+  for (size_t m = 0; m < meshes.size(); m++)
+  {
+    dst[m].scale = glm::vec4(meshes[m].quantization.scale, 0.0f);
+    dst[m].offset = glm::vec4(meshes[m].quantization.offset, 0.0f);
+  }
+}
+
+uint32_t AtomicScene::build(const Instance *instances, const uint32_t *order, size_t count, const Material *materials, size_t material_count,
+                            InstanceData *records, VkDrawIndexedIndirectCommand *commands, uint32_t max_commands)
+{
+  size_t mesh_count = meshes.size();
+  cursor.assign(mesh_count, 0);
+
+  // Histogram
+  for (size_t k = 0; k < count; k++)
+  {
+    const Instance &instance = instances[order ? order[k] : k];
+    if (instance.mesh < mesh_count) cursor[instance.mesh]++;
+  }
+
+  // One command per populated mesh; cursor becomes the mesh's first record slot
+  uint32_t command_count = 0, first = 0;
+  for (size_t m = 0; m < mesh_count; m++)
+  {
+    uint32_t instance_count = cursor[m];
+    cursor[m] = first;
+
+    if (!instance_count) continue;
+
+    // Empty mesh, or out of command slots: its instances are dropped
+    if (!meshes[m].index_count || command_count == max_commands)
+    {
+      cursor[m] = ~0u;
+      continue;
+    }
+
+    VkDrawIndexedIndirectCommand &command = commands[command_count++];
+    command.indexCount = meshes[m].index_count;
+    command.instanceCount = instance_count;
+    command.firstIndex = meshes[m].first_index;
+    command.vertexOffset = meshes[m].vertex_offset;
+    command.firstInstance = first;
+
+    first += instance_count;
+  }
+
+  // Scatter
+  const Material fallback;
+  for (size_t k = 0; k < count; k++)
+  {
+    const Instance &instance = instances[order ? order[k] : k];
+    if (instance.mesh >= mesh_count || cursor[instance.mesh] == ~0u) continue;
+
+    const Material &material = instance.texture < material_count ? materials[instance.texture] : fallback;
+    InstanceData &record = records[cursor[instance.mesh]++];
+    record.model = instance.model;
+    record.texture = material.texture;
+    record.sampler = material.sampler;
+    record.min_lod = material.min_lod;
+    record.mesh = instance.mesh;
+  }
+
+  return command_count;
+}
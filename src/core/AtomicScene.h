@@ -0,0 +1,86 @@
+/**
+ * AtomicScene 0.1
+ *
+ * Many-object scene: meshes are ranges packed into one shared vertex and index
+ * buffer (each with the dequantization of its positions), instances reference a
+ * mesh by id. Each frame the visible instances are
+ * bucketed by mesh into an array of instance records (transform plus the bindless
+ * texture and sampler it samples, read by the shaders from a storage buffer) and
+ * one indexed-indirect command per mesh.
+ */
+
+#ifndef ATOMICSCENE_H
+#define ATOMICSCENE_H
+
+#define SCENE_MAX_INSTANCES         65536  // instance records per frame in flight
+#define SCENE_MAX_MESHES            4096   // indirect commands per frame in flight
+
+class AtomicScene
+{
+ public:
+  // Indices are local to the mesh; vertex_offset places them in the shared vertex buffer
+  struct Mesh
+  {
+    uint32_t first_index = 0, index_count = 0;
+    int32_t vertex_offset = 0;
+    glm::vec3 min = glm::vec3(0.0f), max = glm::vec3(0.0f);  // local bounds, for culling
+    AtomicVertex::Quantization quantization;                 // stored positions -> local
+  };
+
+  // Storage buffer element (std430: 32 bytes), indexed by InstanceData::mesh in the vertex shader
+  struct MeshData
+  {
+    glm::vec4 scale, offset;
+  };
+
+  struct Instance
+  {
+    glm::mat4 model;
+    uint32_t mesh = 0;
+    uint32_t texture = 0;  // streamed texture (AtomicResidency id) it samples
+  };
+
+  // What a texture id resolves to this frame; indexed by Instance::texture, unknown ids get Material{}
+  struct Material
+  {
+    uint32_t texture = 0;  // bindless slot
+    uint32_t sampler = 0;  // AtomicBindless::Sampler
+    float min_lod = 0.0f;  // sampling clamp, in the bound image's levels
+  };
+
+  // Storage buffer element (std430: 80 bytes); the shaders declare the same struct
+  struct InstanceData
+  {
+    glm::mat4 model;
+    uint32_t texture, sampler;
+    float min_lod;
+    uint32_t mesh;
+  };
+
+  AtomicScene () {}
+  AtomicScene (const AtomicScene&) = delete;
+  AtomicScene& operator= (const AtomicScene&) = delete;
+
+  // Shared buffer layout
+  void clear();
+  uint32_t addMesh(uint32_t vertex_count, uint32_t index_count, const glm::vec3 &min, const glm::vec3 &max, const AtomicVertex::Quantization &quantization = {});
+  size_t meshCount() const { return meshes.size(); }
+  const Mesh* mesh(uint32_t id) const { return id < meshes.size() ? &meshes[id] : nullptr; }
+  uint32_t vertexCount() const { return vertex_total; }
+  uint32_t indexCount() const { return index_total; }
+  void packMeshes(MeshData *dst) const;  // meshCount() entries
+
+  // Counting sort by mesh over instances[order[k]], k < count (order: e.g. the visible list from culling; null for
+  // the first `count` instances). Each command's instances land contiguously in `records`, starting at its
+  // firstInstance, with their material resolved. Instances of unknown meshes (a packet older than a reload) are
+  // dropped. Returns the command count.
+  uint32_t build(const Instance *instances, const uint32_t *order, size_t count, const Material *materials, size_t material_count,
+                 InstanceData *records, VkDrawIndexedIndirectCommand *commands, uint32_t max_commands);
+
+ private:
+  std::vector<Mesh> meshes;
+  uint32_t vertex_total = 0, index_total = 0;
+  std::vector<uint32_t> cursor;  // [mesh] scratch for build()
+};
+
+#endif //ATOMICSCENE_H
@@ -0,0 +1,58 @@
+/**
+ * AtomicScheduler 0.1
+ */
+
+void AtomicScheduler::start(unsigned render_hz, unsigned sim_hz)
+{
+  sim_period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / sim_hz));
+  setRenderRate(render_hz);
+
+  last_frame = deadline = clock::now();
+  accumulator = clock::duration(0);
+  pending_steps = 0;
+}
+
+void AtomicScheduler::setRenderRate(unsigned render_hz)
+{
+  render_period = render_hz ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / render_hz))
+                            : clock::duration(0);
+}
+
+void AtomicScheduler::wait()
+{
+  if (render_period.count())
+  {
+    deadline += render_period;
+    clock::time_point now = clock::now();
+
+    // Fell more than a frame behind (stall, breakpoint, resize): resync instead of bursting
+    if (now > deadline + render_period) deadline = now;
+
+    // Coarse sleep, then spin the tail: sleep granularity is far worse than the clock's
+    else if (deadline - now > std::chrono::microseconds(SCHEDULER_SPIN_US))
+      std::this_thread::sleep_until(deadline - std::chrono::microseconds(SCHEDULER_SPIN_US));
+
+    while (clock::now() < deadline)
+      std::this_thread::yield();
+  }
+
+  clock::time_point now = clock::now();
+  clock::duration elapsed = now - last_frame;
+  last_frame = now;
+  frame_seconds = std::chrono::duration<double>(elapsed).count();
+
+  // Fixed-timestep accumulator
+  accumulator += elapsed;
+  pending_steps = 0;
+  while (accumulator >= sim_period && pending_steps < SCHEDULER_MAX_STEPS)
+  {
+    accumulator -= sim_period;
+    pending_steps++;
+  }
+  if (accumulator >= sim_period) accumulator = clock::duration(0);
+}
+
+double AtomicScheduler::alpha() const
+{
+  return std::chrono::duration<double>(accumulator).count() / stepSeconds();
+}
@@ -0,0 +1,47 @@
+/**
+ * AtomicScheduler 0.1
+ *
+ * Frame pacing on a monotonic clock: sleeps until the next frame deadline and
+ * spins only the last stretch. Simulation runs on a fixed timestep, decoupled
+ * from the render rate, with an interpolation factor for rendering between steps.
+ */
+
+#ifndef ATOMICSCHEDULER_H
+#define ATOMICSCHEDULER_H
+
+#include <chrono>
+#include <thread>
+
+#define SCHEDULER_SIM_HZ            120   // fixed simulation rate
+#define SCHEDULER_MAX_STEPS         8     // per frame; beyond this the simulation slows down instead of spiralling
+#define SCHEDULER_SPIN_US           500   // sleep until this close to the deadline, then spin
+
+class AtomicScheduler
+{
+ public:
+  using clock = std::chrono::steady_clock;
+
+  AtomicScheduler () {}
+  AtomicScheduler (const AtomicScheduler&) = delete;
+  AtomicScheduler& operator= (const AtomicScheduler&) = delete;
+
+  void start(unsigned render_hz, unsigned sim_hz = SCHEDULER_SIM_HZ);
+  void setRenderRate(unsigned render_hz);  // 0: uncapped
+
+  // Block until the next frame is due, then advance the simulation clock
+  void wait();
+
+  unsigned steps() const { return pending_steps; }  // fixed steps to run this frame
+  double stepSeconds() const { return std::chrono::duration<double>(sim_period).count(); }
+  double alpha() const;                             // [0,1) between the last two steps
+  double frameSeconds() const { return frame_seconds; }
+
+ private:
+  clock::duration render_period{0}, sim_period{0};
+  clock::time_point deadline, last_frame;
+  clock::duration accumulator{0};
+  unsigned pending_steps = 0;
+  double frame_seconds = 0;
+};
+
+#endif //ATOMICSCHEDULER_H
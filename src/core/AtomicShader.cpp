@@ -0,0 +1,221 @@
+/**
+ * AtomicShader 0.1
+ */
+
+void AtomicShader::init(VkDevice d)
+{
+  device = d;
+
+  std::string exe_dir = executableDir();
+  source_dir = exe_dir + "/" + SHADER_SOURCE_DIR;
+  cache_dir  = exe_dir + "/" + SHADER_CACHE_DIR;
+  mkdir(cache_dir.c_str(), 0755);
+
+  compiler = shaderc_compiler_initialize();
+  if (!compiler) throw std::runtime_error("failed to initialize shader compiler!");
+
+#ifdef __linux__
+  // Editors either rewrite in place or rename over the file; watch for both
+  if (SHADER_HOT_RELOAD && (watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) >= 0)
+    inotify_add_watch(watch_fd, source_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+#endif
+
+  if (ATOMICENGINE_DEBUG)
+    printf("Shaders: %s (cache: %s)\n", source_dir.c_str(), cache_dir.c_str());
+}
+
+void AtomicShader::destroy()
+{
+  if (watch_fd >= 0) close(watch_fd);
+  watch_fd = -1;
+  loaded.clear();
+
+  if (compiler) shaderc_compiler_release(compiler);
+  compiler = nullptr;
+}
+
+VkShaderModule AtomicShader::load(const std::string &name, const std::vector<std::string> &defines)
+{
+  loaded[name] = modified(name);
+
+  std::string source;
+  if (!readText(sourcePath(name), source))
+    throw std::runtime_error("failed to read shader source: " + sourcePath(name));
+
+  // Key: source bytes, defines and cache version
+  std::string key = source;
+  for (const auto &define : defines) key += '\0' + define;
+  key += '\0' + std::to_string(SHADER_CACHE_VERSION);
+
+  char hash[17];
+  snprintf(hash, sizeof(hash), "%016llx", (unsigned long long) AtomicMesh::hashBytes(key.data(), key.size()));
+  std::string cache_path = cache_dir + "/" + name + "." + hash + ".spv";
+
+  // Cache hit: map and hand straight to the driver
+  if (VkShaderModule module = mapModule(cache_path))
+    return module;
+
+  std::vector<uint32_t> spirv;
+  compile(name, source, defines, spirv);
+
+  if (!atomicengine_write_file(cache_path, spirv.data(), spirv.size() * sizeof(uint32_t)) && ATOMICENGINE_DEBUG)
+    printf("Shader cache write failed: %s\n", cache_path.c_str());
+
+  return createModule(spirv.data(), spirv.size() * sizeof(uint32_t));
+}
+
+std::vector<std::string> AtomicShader::changed()
+{
+  std::set<std::string> names;
+
+#ifdef __linux__
+  if (watch_fd >= 0)
+  {
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t len;
+
+    while ((len = read(watch_fd, buffer, sizeof(buffer))) > 0)
+      for (char *p = buffer; p < buffer + len; p += sizeof(struct inotify_event) + ((struct inotify_event*) p)->len)
+      {
+        auto *event = (struct inotify_event*) p;
+        if (!event->len) continue;
+
+        // "shader.vert.glsl" => "shader.vert"
+        std::string file = event->name;
+        size_t dot = file.find_last_of('.');
+        if (dot == std::string::npos) continue;
+
+        std::string name = file.substr(0, dot), ext = file.substr(dot);
+        if (ext == ".glsl" && loaded.count(name)) names.insert(name);
+      }
+
+    return std::vector<std::string>(names.begin(), names.end());
+  }
+#endif
+
+  // No inotify: compare modification times
+  if (SHADER_HOT_RELOAD)
+    for (auto &[name, mtime] : loaded)
+    {
+      time_t now = modified(name);
+      if (now != mtime) { mtime = now; names.insert(name); }
+    }
+
+  return std::vector<std::string>(names.begin(), names.end());
+}
+
+void AtomicShader::compile(const std::string &name, const std::string &source, const std::vector<std::string> &defines, std::vector<uint32_t> &spirv)
+{
+  shaderc_shader_kind kind;
+  if      (name.ends_with(".vert")) kind = shaderc_vertex_shader;
+  else if (name.ends_with(".frag")) kind = shaderc_fragment_shader;
+  else if (name.ends_with(".comp")) kind = shaderc_compute_shader;
+  else if (name.ends_with(".geom")) kind = shaderc_geometry_shader;
+  else throw std::runtime_error("unknown shader stage: " + name);
+
+  shaderc_compile_options_t options = shaderc_compile_options_initialize();
+  shaderc_compile_options_set_target_env(options, shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+  shaderc_compile_options_set_optimization_level(options, shaderc_optimization_level_performance);
+
+  // "NAME" or "NAME=VALUE"
+  for (const auto &define : defines)
+  {
+    size_t eq = define.find('=');
+    if (eq == std::string::npos) shaderc_compile_options_add_macro_definition(options, define.c_str(), define.size(), nullptr, 0);
+    else shaderc_compile_options_add_macro_definition(options, define.c_str(), eq, define.c_str() + eq + 1, define.size() - eq - 1);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  shaderc_compilation_result_t result = shaderc_compile_into_spv(compiler, source.data(), source.size(), kind, name.c_str(), "main", options);
+  shaderc_compile_options_release(options);
+
+  if (shaderc_result_get_compilation_status(result) != shaderc_compilation_status_success)
+  {
+    std::string error = shaderc_result_get_error_message(result);
+    shaderc_result_release(result);
+    throw std::runtime_error("failed to compile shader " + name + ":\n" + error);
+  }
+
+  spirv.resize(shaderc_result_get_length(result) / sizeof(uint32_t));
+  memcpy(spirv.data(), shaderc_result_get_bytes(result), spirv.size() * sizeof(uint32_t));
+  shaderc_result_release(result);
+
+  if (ATOMICENGINE_DEBUG)
+    printf("Compiled shader %s: %.2f ms, %zu bytes\n", name.c_str(), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), spirv.size() * sizeof(uint32_t));
+}
+
+VkShaderModule AtomicShader::createModule(const void *code, size_t size)
+{
+  VkShaderModuleCreateInfo createInfo{};
+  createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+  createInfo.codeSize = size;
+  createInfo.pCode = (const uint32_t*) code;
+
+  VkShaderModule module;
+  if (vkCreateShaderModule(device, &createInfo, nullptr, &module) != VK_SUCCESS)
+    throw std::runtime_error("failed to create shader module!");
+
+  return module;
+}
+
+VkShaderModule AtomicShader::mapModule(const std::string &path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return VK_NULL_HANDLE;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < 4 || st.st_size % 4)
+  {
+    close(fd);
+    return VK_NULL_HANDLE;
+  }
+
+  void *map = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return VK_NULL_HANDLE;
+
+  // SPIR-V magic, otherwise treat as a miss
+  VkShaderModule module = VK_NULL_HANDLE;
+  if (*(const uint32_t*) map == 0x07230203)
+    module = createModule(map, (size_t) st.st_size);
+
+  munmap(map, (size_t) st.st_size);
+  return module;
+}
+
+time_t AtomicShader::modified(const std::string &name) const
+{
+  struct stat st;
+  time_t mtime = 0;
+  if (stat(sourcePath(name).c_str(), &st) == 0) mtime = st.st_mtime;
+  return mtime;
+}
+
+std::string AtomicShader::executableDir()
+{
+  char path[4096] = {0};
+
+#ifdef __APPLE__
+  uint32_t size = sizeof(path);
+  if (_NSGetExecutablePath(path, &size) != 0) return ".";
+#else
+  ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  if (len <= 0) return ".";
+  path[len] = 0;
+#endif
+
+  std::string dir(path);
+  size_t slash = dir.find_last_of('/');
+  return slash == std::string::npos ? "." : dir.substr(0, slash);
+}
+
+bool AtomicShader::readText(const std::string &path, std::string &out)
+{
+  std::ifstream file(path, std::ios::ate | std::ios::binary);
+  if (!file.is_open()) return false;
+
+  out.resize((size_t) file.tellg());
+  file.seekg(0);
+  file.read(out.data(), out.size());
+  return (bool) file;
+}
@@ -0,0 +1,67 @@
+/**
+ * AtomicShader 0.1
+ *
+ * GLSL -> SPIR-V in-process with libshaderc, cached on disk by a hash of
+ * source + defines. Paths resolve relative to the executable.
+ * Loaded shaders are watched (inotify on Linux) for hot-reload.
+ */
+
+#ifndef ATOMICSHADER_H
+#define ATOMICSHADER_H
+
+#include <vulkan/vulkan.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include <shaderc/shaderc.h>
+
+#define SHADER_SOURCE_DIR           "../src/shaders"   // relative to the executable
+#define SHADER_CACHE_DIR            "shadercache"      // relative to the executable
+#define SHADER_CACHE_VERSION        2                  // bump to invalidate every cached blob
+#define SHADER_HOT_RELOAD           ATOMICENGINE_DEBUG
+
+class AtomicShader
+{
+ public:
+  AtomicShader () {}
+  AtomicShader (const AtomicShader&) = delete;
+  AtomicShader& operator= (const AtomicShader&) = delete;
+
+  void init(VkDevice device);
+  void destroy();
+
+  // name: "<stem>.<stage>", e.g. "shader.vert" for src/shaders/shader.vert.glsl
+  VkShaderModule load(const std::string &name, const std::vector<std::string> &defines = {});
+
+  // Names of loaded shaders whose GLSL source changed since the last call
+  std::vector<std::string> changed();
+
+  std::string sourcePath(const std::string &name) const { return source_dir + "/" + name + ".glsl"; }
+  static std::string executableDir();
+
+ private:
+  VkDevice device = VK_NULL_HANDLE;
+  std::string source_dir, cache_dir;
+  std::unordered_map<std::string, time_t> loaded;   // name => newest mtime of its files
+  int watch_fd = -1;
+
+  shaderc_compiler_t compiler = nullptr;
+
+  void compile(const std::string &name, const std::string &source, const std::vector<std::string> &defines, std::vector<uint32_t> &spirv);
+  VkShaderModule createModule(const void *code, size_t size);
+  VkShaderModule mapModule(const std::string &path);
+  time_t modified(const std::string &name) const;
+
+  static bool readText(const std::string &path, std::string &out);
+};
+
+#endif //ATOMICSHADER_H
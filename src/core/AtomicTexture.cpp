@@ -0,0 +1,633 @@
+/**
+ * AtomicTexture 0.1
+ */
+
+// sRGB <-> linear: exact table one way, 12-bit linear quantization back.
+// to_linear[256 + a] is alpha, passed through unscaled, so one gather serves a whole RGBA texel.
+struct AtomicSrgbTables
+{
+  float to_linear[512];
+  uint8_t to_srgb[4096];
+
+  AtomicSrgbTables()
+  {
+    for (int i = 0; i < 256; i++)
+    {
+      float c = i / 255.0f;
+      to_linear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+      to_linear[256 + i] = (float) i;
+    }
+
+    for (int i = 0; i < 4096; i++)
+    {
+      float l = i / 4095.0f;
+      float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+      to_srgb[i] = (uint8_t) std::clamp((int) std::lround(c * 255.0f), 0, 255);
+    }
+  }
+};
+
+static const AtomicSrgbTables& srgbTables()
+{
+  static const AtomicSrgbTables tables;
+  return tables;
+}
+
+// Box sum of four texels -> table index (RGB) or alpha: sum * scale + 0.5, truncated
+static const float texture_filter_scale[4] = { 4095.0f * 0.25f, 4095.0f * 0.25f, 4095.0f * 0.25f, 0.25f };
+
+static uint64_t textureLevelBytes(VkFormat format, uint32_t width, uint32_t height)
+{
+  uint32_t block = AtomicTexture::blockBytes(format);
+  if (!block) return (uint64_t) width * height * 4;
+  return (uint64_t) ((width + 3) / 4) * ((height + 3) / 4) * block;
+}
+
+bool AtomicTexture::load(const std::string &source, bool compressed, AtomicJobs &jobs)
+{
+  if (loadCache(source, compressed)) return true;
+
+  int w, h, channels;
+  stbi_uc *pixels = stbi_load(source.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+  if (!pixels) return false;
+
+  auto start = std::chrono::steady_clock::now();
+  build(pixels, (uint32_t) w, (uint32_t) h, compressed, jobs);
+  stbi_image_free(pixels);
+
+  if (ATOMICENGINE_DEBUG)
+    printf("Encoded texture: %s (%s, %zu levels, %.1f ms)\n", source.c_str(), formatName(format), levels.size(),
+           std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+  if (!storeCache(source, compressed) && ATOMICENGINE_DEBUG)
+    printf("Unable to write texture cache: %s\n", cachePath(source, compressed).c_str());
+
+  return true;
+}
+
+void AtomicTexture::build(const uint8_t *rgba, uint32_t w, uint32_t h, bool compressed, AtomicJobs &jobs)
+{
+  release();
+
+  width = w;
+  height = h;
+
+  // BC1 carries no useful alpha; any translucent texel needs BC7
+  bool alpha = false;
+  for (size_t i = 0; i < (size_t) w * h && !alpha; i++) alpha = rgba[i * 4 + 3] != 0xFF;
+
+  format = !compressed ? VK_FORMAT_R8G8B8A8_SRGB : alpha ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+
+  // Level index
+  uint32_t level_count = std::min<uint32_t>(TEXTURE_MAX_LEVELS, (uint32_t) std::floor(std::log2(std::max(w, h))) + 1);
+  uint64_t offset = 0;
+  for (uint32_t l = 0; l < level_count; l++)
+  {
+    Level level;
+    level.width = std::max(1u, w >> l);
+    level.height = std::max(1u, h >> l);
+    level.offset = offset;
+    level.size = textureLevelBytes(format, level.width, level.height);
+    levels.push_back(level);
+
+    offset = alignUp(offset + level.size, 16);
+  }
+
+  owned.resize((size_t) size());
+
+  // Mip chain: straight into the output when uncompressed, else into scratch for the encoder
+  uint32_t block = blockBytes(format);
+  std::vector<const uint8_t*> pixels(level_count);
+  std::vector<uint8_t> chain;
+
+  if (block)
+  {
+    size_t chain_size = 0;
+    for (uint32_t l = 1; l < level_count; l++) chain_size += (size_t) levels[l].width * levels[l].height * 4;
+    chain.resize(chain_size);
+    pixels[0] = rgba;
+  }
+  else
+  {
+    memcpy(owned.data(), rgba, (size_t) levels[0].size);
+    pixels[0] = owned.data();
+  }
+
+  Kernel kernel = best();
+  size_t chain_offset = 0;
+  for (uint32_t l = 1; l < level_count; l++)
+  {
+    uint8_t *next = block ? chain.data() + chain_offset : owned.data() + levels[l].offset;
+    downsampleParallel(jobs, pixels[l - 1], levels[l - 1].width, levels[l - 1].height, next, kernel);
+
+    pixels[l] = next;
+    chain_offset += (size_t) levels[l].width * levels[l].height * 4;
+  }
+
+  if (!block) return;
+
+  // Block rows of every level in one pass, so the small levels don't each wait on a fan-out of their own
+  std::vector<uint32_t> first_row(level_count + 1, 0);
+  for (uint32_t l = 0; l < level_count; l++) first_row[l + 1] = first_row[l] + (levels[l].height + 3) / 4;
+
+  jobs.parallelFor(first_row[level_count], TEXTURE_ENCODE_GRAIN, [&](size_t begin, size_t end)
+  {
+    uint8_t texels[64];
+    uint32_t l = 0;
+
+    for (size_t row = begin; row < end; row++)
+    {
+      while (row >= first_row[l + 1]) l++;
+
+      const Level &level = levels[l];
+      const uint8_t *src = pixels[l];
+      uint32_t by = (uint32_t) row - first_row[l], blocks_x = (level.width + 3) / 4;
+
+      for (uint32_t bx = 0; bx < blocks_x; bx++)
+      {
+        // Edge blocks repeat the last row/column
+        for (uint32_t y = 0; y < 4; y++)
+          for (uint32_t x = 0; x < 4; x++)
+          {
+            uint32_t sx = std::min(bx * 4 + x, level.width - 1), sy = std::min(by * 4 + y, level.height - 1);
+            memcpy(texels + (y * 4 + x) * 4, src + ((size_t) sy * level.width + sx) * 4, 4);
+          }
+
+        uint8_t *out = owned.data() + level.offset + ((size_t) by * blocks_x + bx) * block;
+        if (format == VK_FORMAT_BC7_SRGB_BLOCK) encodeBC7(texels, out);
+        else encodeBC1(texels, out);
+      }
+    }
+  });
+}
+
+bool AtomicTexture::loadCache(const std::string &source, bool compressed)
+{
+  release();
+
+  uint64_t source_size;
+  int64_t source_mtime;
+  if (!AtomicMesh::sourceStat(source.c_str(), source_size, source_mtime))
+    return false;
+
+  int fd = open(cachePath(source, compressed).c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CacheHeader))
+  {
+    close(fd);
+    return false;
+  }
+
+  void *map = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return false;
+
+  // Validate: container version, source identity (path, size, mtime), then every level against the format
+  const CacheHeader *header = (const CacheHeader*) map;
+  bool valid = header->magic == TEXTURE_CACHE_MAGIC && header->version == TEXTURE_CACHE_VERSION
+               && header->source_hash == AtomicMesh::hashBytes(source.data(), source.size())
+               && header->source_size == source_size && header->source_mtime == source_mtime
+               && header->level_count && header->level_count <= TEXTURE_MAX_LEVELS
+               && header->pixel_width && header->pixel_height;
+
+  uint64_t base = alignUp(sizeof(CacheHeader), 16);
+  for (uint32_t l = 0; valid && l < header->level_count; l++)
+  {
+    uint32_t lw = std::max(1u, header->pixel_width >> l), lh = std::max(1u, header->pixel_height >> l);
+    valid = header->level_index[l].byte_offset >= base
+            && header->level_index[l].byte_length == textureLevelBytes((VkFormat) header->vk_format, lw, lh)
+            && header->level_index[l].byte_offset + header->level_index[l].byte_length <= (uint64_t) st.st_size;
+
+    if (valid) levels.push_back({header->level_index[l].byte_offset - base, header->level_index[l].byte_length, lw, lh});
+  }
+
+  if (!valid)
+  {
+    levels.clear();
+    munmap(map, (size_t) st.st_size);
+    return false;
+  }
+
+  mapping = map;
+  mapping_size = (size_t) st.st_size;
+  data_offset = (size_t) base;
+
+  format = (VkFormat) header->vk_format;
+  width = header->pixel_width;
+  height = header->pixel_height;
+
+  if (ATOMICENGINE_DEBUG)
+    printf("Texture cache hit: %s (%s, %ux%u, %zu levels)\n", source.c_str(), formatName(format), width, height, levels.size());
+
+  return true;
+}
+
+bool AtomicTexture::storeCache(const std::string &source, bool compressed) const
+{
+  if (levels.empty()) return false;
+
+  CacheHeader header{};
+  header.magic        = TEXTURE_CACHE_MAGIC;
+  header.version      = TEXTURE_CACHE_VERSION;
+  header.source_hash  = AtomicMesh::hashBytes(source.data(), source.size());
+  header.vk_format    = (uint32_t) format;
+  header.pixel_width  = width;
+  header.pixel_height = height;
+  header.level_count  = (uint32_t) levels.size();
+
+  uint64_t base = alignUp(sizeof(CacheHeader), 16);
+  for (size_t l = 0; l < levels.size(); l++)
+  {
+    header.level_index[l].byte_offset = base + levels[l].offset;
+    header.level_index[l].byte_length = levels[l].size;
+  }
+
+  if (!AtomicMesh::sourceStat(source.c_str(), header.source_size, header.source_mtime))
+    return false;
+
+  return atomicengine_write_file(cachePath(source, compressed), [&](std::ofstream &file)
+  {
+    static const char padding[16] = {0};
+    file.write((const char*) &header, sizeof(header));
+    file.write(padding, base - sizeof(header));
+    file.write((const char*) data(), (std::streamsize) size());
+  });
+}
+
+void AtomicTexture::release()
+{
+  if (mapping) munmap(mapping, mapping_size);
+  mapping = nullptr;
+  mapping_size = data_offset = 0;
+
+  owned.clear();
+  owned.shrink_to_fit();
+  levels.clear();
+}
+
+uint32_t AtomicTexture::blockBytes(VkFormat format)
+{
+  switch (format)
+  {
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK: return 8;
+    case VK_FORMAT_BC7_SRGB_BLOCK:      return 16;
+    default:                            return 0;
+  }
+}
+
+const char* AtomicTexture::formatName(VkFormat format)
+{
+  switch (format)
+  {
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK: return "BC1";
+    case VK_FORMAT_BC7_SRGB_BLOCK:      return "BC7";
+    case VK_FORMAT_R8G8B8A8_SRGB:       return "RGBA8";
+    default:                            return "unknown";
+  }
+}
+
+void AtomicTexture::downsample(const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, uint32_t y_begin, uint32_t y_end, Kernel kernel)
+{
+  y_end = std::min(y_end, std::max(1u, h / 2));
+  if (y_begin >= y_end) return;
+  if (kernel == Auto) kernel = best();
+
+#if TEXTURE_X86
+  if (kernel == AVX2) return downsampleAVX2(src, w, h, dst, y_begin, y_end);
+  if (kernel == SSE) return downsampleSSE(src, w, h, dst, y_begin, y_end);
+#endif
+
+  downsampleScalar(src, w, h, dst, y_begin, y_end);
+}
+
+void AtomicTexture::downsampleParallel(AtomicJobs &jobs, const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, Kernel kernel)
+{
+  if (kernel == Auto) kernel = best();
+
+  jobs.parallelFor(std::max(1u, h / 2), TEXTURE_MIP_GRAIN, [&](size_t begin, size_t end)
+  {
+    downsample(src, w, h, dst, (uint32_t) begin, (uint32_t) end, kernel);
+  });
+}
+
+AtomicTexture::Kernel AtomicTexture::best()
+{
+#if TEXTURE_X86 && (defined(__GNUC__) || defined(__clang__))
+  static const Kernel kernel = __builtin_cpu_supports("avx2") ? AVX2 : __builtin_cpu_supports("sse2") ? SSE : Scalar;
+  return kernel;
+#elif TEXTURE_X86
+  return SSE;
+#else
+  return Scalar;
+#endif
+}
+
+// One destination texel from source columns x0/x1 of two rows; the SIMD kernels sum in the same order
+static inline void downsampleTexel(const uint8_t *row0, const uint8_t *row1, uint32_t x0, uint32_t x1, uint8_t *out)
+{
+  const AtomicSrgbTables &tables = srgbTables();
+
+  for (int c = 0; c < 4; c++)
+  {
+    const float *linear = tables.to_linear + (c < 3 ? 0 : 256);
+    float sum = (linear[row0[x0 + c]] + linear[row1[x0 + c]]) + (linear[row0[x1 + c]] + linear[row1[x1 + c]]);
+    int q = (int) (sum * texture_filter_scale[c] + 0.5f);
+    out[c] = c < 3 ? tables.to_srgb[q] : (uint8_t) q;
+  }
+}
+
+void AtomicTexture::downsampleScalar(const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, uint32_t y_begin, uint32_t y_end)
+{
+  uint32_t dw = std::max(1u, w / 2);
+
+  for (uint32_t y = y_begin; y < y_end; y++)
+  {
+    // Odd edges drop the last row/column; a 1-wide (or 1-tall) source repeats its only one
+    const uint8_t *row0 = src + (size_t) std::min(2 * y, h - 1) * w * 4;
+    const uint8_t *row1 = src + (size_t) std::min(2 * y + 1, h - 1) * w * 4;
+
+    for (uint32_t x = 0; x < dw; x++)
+      downsampleTexel(row0, row1, std::min(2 * x, w - 1) * 4, std::min(2 * x + 1, w - 1) * 4, dst + ((size_t) y * dw + x) * 4);
+  }
+}
+
+#if TEXTURE_X86
+
+__attribute__((target("sse2")))
+static inline __m128 linearTexel(const float *linear, const uint8_t *p)
+{
+  return _mm_setr_ps(linear[p[0]], linear[p[1]], linear[p[2]], linear[256 + p[3]]);
+}
+
+// Two adjacent texels; lane adds 256 to the alpha indices
+__attribute__((target("avx2")))
+static inline __m256 linearTexels(const float *linear, __m256i lane, const uint8_t *p)
+{
+  return _mm256_i32gather_ps(linear, _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) p)), lane), 4);
+}
+
+// One texel per iteration: table loads are scalar, the box sum and quantization are 4-wide
+__attribute__((target("sse2")))
+void AtomicTexture::downsampleSSE(const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, uint32_t y_begin, uint32_t y_end)
+{
+  if (w < 2) return downsampleScalar(src, w, h, dst, y_begin, y_end);
+
+  const AtomicSrgbTables &tables = srgbTables();
+  const float *linear = tables.to_linear;
+  const __m128 scale = _mm_loadu_ps(texture_filter_scale), half = _mm_set1_ps(0.5f);
+
+  uint32_t dw = w / 2;
+  alignas(16) int32_t q[4];
+
+  for (uint32_t y = y_begin; y < y_end; y++)
+  {
+    const uint8_t *row0 = src + (size_t) std::min(2 * y, h - 1) * w * 4;
+    const uint8_t *row1 = src + (size_t) std::min(2 * y + 1, h - 1) * w * 4;
+    uint8_t *out = dst + (size_t) y * dw * 4;
+
+    for (uint32_t x = 0; x < dw; x++, out += 4)
+    {
+      const uint8_t *a = row0 + x * 8, *b = row1 + x * 8;
+      __m128 sum = _mm_add_ps(_mm_add_ps(linearTexel(linear, a), linearTexel(linear, b)), _mm_add_ps(linearTexel(linear, a + 4), linearTexel(linear, b + 4)));
+      _mm_store_si128((__m128i*) q, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(sum, scale), half)));
+
+      out[0] = tables.to_srgb[q[0]];
+      out[1] = tables.to_srgb[q[1]];
+      out[2] = tables.to_srgb[q[2]];
+      out[3] = (uint8_t) q[3];
+    }
+  }
+}
+
+// Two texels per iteration: each gather linearizes two source texels (RGB through the curve, alpha as is)
+__attribute__((target("avx2")))
+void AtomicTexture::downsampleAVX2(const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, uint32_t y_begin, uint32_t y_end)
+{
+  if (w < 2) return downsampleScalar(src, w, h, dst, y_begin, y_end);
+
+  const AtomicSrgbTables &tables = srgbTables();
+  const float *linear = tables.to_linear;
+  const __m256 scale = _mm256_broadcast_ps((const __m128*) texture_filter_scale), half = _mm256_set1_ps(0.5f);
+  const __m256i lane = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+
+  uint32_t dw = w / 2;
+  alignas(32) int32_t q[8];
+
+  for (uint32_t y = y_begin; y < y_end; y++)
+  {
+    const uint8_t *row0 = src + (size_t) std::min(2 * y, h - 1) * w * 4;
+    const uint8_t *row1 = src + (size_t) std::min(2 * y + 1, h - 1) * w * 4;
+    uint8_t *out = dst + (size_t) y * dw * 4;
+
+    uint32_t x = 0;
+    for (; x + 2 <= dw; x += 2, out += 8)
+    {
+      // Vertical pairs of source texels 2x, 2x+1 and 2x+2, 2x+3, then the horizontal pairs across the halves
+      const uint8_t *a = row0 + x * 8, *b = row1 + x * 8;
+      __m256 left = _mm256_add_ps(linearTexels(linear, lane, a), linearTexels(linear, lane, b));
+      __m256 right = _mm256_add_ps(linearTexels(linear, lane, a + 8), linearTexels(linear, lane, b + 8));
+      __m256 sum = _mm256_add_ps(_mm256_permute2f128_ps(left, right, 0x20), _mm256_permute2f128_ps(left, right, 0x31));
+      _mm256_store_si256((__m256i*) q, _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(sum, scale), half)));
+
+      for (int t = 0; t < 2; t++)
+      {
+        out[t * 4 + 0] = tables.to_srgb[q[t * 4 + 0]];
+        out[t * 4 + 1] = tables.to_srgb[q[t * 4 + 1]];
+        out[t * 4 + 2] = tables.to_srgb[q[t * 4 + 2]];
+        out[t * 4 + 3] = (uint8_t) q[t * 4 + 3];
+      }
+    }
+
+    for (; x < dw; x++, out += 4)
+      downsampleTexel(row0, row1, x * 8, x * 8 + 4, out);
+  }
+}
+
+#endif
+
+// Principal axis of N-channel texels: power iteration on the covariance, seeded with its largest column
+template<int N> static void principalAxis(const uint8_t *rgba, float mean[N], float axis[N])
+{
+  float cov[N][N] = {};
+  for (int c = 0; c < N; c++) mean[c] = 0;
+  for (int i = 0; i < 16; i++)
+    for (int c = 0; c < N; c++) mean[c] += rgba[i * 4 + c] / 16.0f;
+
+  for (int i = 0; i < 16; i++)
+    for (int a = 0; a < N; a++)
+      for (int b = 0; b < N; b++)
+        cov[a][b] += (rgba[i * 4 + a] - mean[a]) * (rgba[i * 4 + b] - mean[b]);
+
+  int seed = 0;
+  for (int c = 1; c < N; c++) if (cov[c][c] > cov[seed][seed]) seed = c;
+  for (int c = 0; c < N; c++) axis[c] = cov[c][seed];
+
+  for (int iteration = 0; iteration < 8; iteration++)
+  {
+    float next[N] = {}, length = 0;
+    for (int a = 0; a < N; a++)
+    {
+      for (int b = 0; b < N; b++) next[a] += cov[a][b] * axis[b];
+      length += next[a] * next[a];
+    }
+
+    if (length <= 1e-12f) break;
+    length = 1.0f / std::sqrt(length);
+    for (int c = 0; c < N; c++) axis[c] = next[c] * length;
+  }
+}
+
+// Extremes of the texels projected on the axis
+template<int N> static void axisRange(const uint8_t *rgba, const float mean[N], const float axis[N], float low[N], float high[N])
+{
+  float t_min = 0, t_max = 0;
+  for (int i = 0; i < 16; i++)
+  {
+    float t = 0;
+    for (int c = 0; c < N; c++) t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+    t_min = std::min(t_min, t);
+    t_max = std::max(t_max, t);
+  }
+
+  for (int c = 0; c < N; c++)
+  {
+    low[c] = std::clamp(mean[c] + axis[c] * t_min, 0.0f, 255.0f);
+    high[c] = std::clamp(mean[c] + axis[c] * t_max, 0.0f, 255.0f);
+  }
+}
+
+// BC1, 4-colour mode: RGB565 endpoints along the principal axis, 2-bit nearest-palette indices
+void AtomicTexture::encodeBC1(const uint8_t *rgba, uint8_t *out)
+{
+  float mean[3], axis[3], low[3], high[3];
+  principalAxis<3>(rgba, mean, axis);
+  axisRange<3>(rgba, mean, axis, low, high);
+
+  auto pack565 = [](const float c[3]) {
+    return (uint16_t) ((std::lround(c[0] * 31 / 255.0f) << 11) | (std::lround(c[1] * 63 / 255.0f) << 5) | std::lround(c[2] * 31 / 255.0f));
+  };
+
+  uint16_t c0 = pack565(high), c1 = pack565(low);
+  if (c0 < c1) std::swap(c0, c1);
+
+  uint32_t bits = 0;
+  if (c0 != c1)
+  {
+    // c0 > c1 selects the 4-colour palette: c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+    int palette[4][3];
+    for (int e = 0; e < 2; e++)
+    {
+      uint16_t c = e ? c1 : c0;
+      int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+      palette[e][0] = (r << 3) | (r >> 2);
+      palette[e][1] = (g << 2) | (g >> 4);
+      palette[e][2] = (b << 3) | (b >> 2);
+    }
+    for (int c = 0; c < 3; c++)
+    {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+      int best = 0, best_error = INT32_MAX;
+      for (int p = 0; p < 4; p++)
+      {
+        int error = 0;
+        for (int c = 0; c < 3; c++) error += (rgba[i * 4 + c] - palette[p][c]) * (rgba[i * 4 + c] - palette[p][c]);
+        if (error < best_error) best = p, best_error = error;
+      }
+      bits |= (uint32_t) best << (i * 2);
+    }
+  }
+
+  out[0] = c0 & 0xFF; out[1] = c0 >> 8;
+  out[2] = c1 & 0xFF; out[3] = c1 >> 8;
+  for (int b = 0; b < 4; b++) out[4 + b] = (bits >> (b * 8)) & 0xFF;
+}
+
+// BC7 mode 6: one subset, RGBA 7-bit endpoints + a p-bit each, 4-bit indices
+void AtomicTexture::encodeBC7(const uint8_t *rgba, uint8_t *out)
+{
+  static const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+  float mean[4], axis[4], ends[2][4];
+  principalAxis<4>(rgba, mean, axis);
+  axisRange<4>(rgba, mean, axis, ends[0], ends[1]);
+
+  // Quantize each endpoint with whichever p-bit reconstructs it closer
+  int q[2][4], p[2], endpoint[2][4];
+  for (int e = 0; e < 2; e++)
+  {
+    float best_error = 1e30f;
+    for (int bit = 0; bit < 2; bit++)
+    {
+      int candidate[4];
+      float error = 0;
+      for (int c = 0; c < 4; c++)
+      {
+        candidate[c] = std::clamp((int) std::lround((ends[e][c] - bit) / 2.0f), 0, 127);
+        float d = ((candidate[c] << 1) | bit) - ends[e][c];
+        error += d * d;
+      }
+
+      if (error < best_error)
+      {
+        best_error = error;
+        p[e] = bit;
+        for (int c = 0; c < 4; c++) q[e][c] = candidate[c];
+      }
+    }
+
+    for (int c = 0; c < 4; c++) endpoint[e][c] = (q[e][c] << 1) | p[e];
+  }
+
+  int palette[16][4], index[16];
+  for (int w = 0; w < 16; w++)
+    for (int c = 0; c < 4; c++)
+      palette[w][c] = ((64 - weights[w]) * endpoint[0][c] + weights[w] * endpoint[1][c] + 32) >> 6;
+
+  for (int i = 0; i < 16; i++)
+  {
+    int best = 0, best_error = INT32_MAX;
+    for (int w = 0; w < 16; w++)
+    {
+      int error = 0;
+      for (int c = 0; c < 4; c++) error += (rgba[i * 4 + c] - palette[w][c]) * (rgba[i * 4 + c] - palette[w][c]);
+      if (error < best_error) best = w, best_error = error;
+    }
+    index[i] = best;
+  }
+
+  // The anchor (texel 0) index is stored without its top bit: flip the endpoints if it is set
+  if (index[0] & 8)
+  {
+    std::swap(q[0], q[1]);
+    std::swap(p[0], p[1]);
+    for (int i = 0; i < 16; i++) index[i] = 15 - index[i];
+  }
+
+  memset(out, 0, 16);
+  unsigned position = 0;
+  auto put = [&](uint32_t value, unsigned count) {
+    for (unsigned b = 0; b < count; b++, position++)
+      out[position >> 3] |= ((value >> b) & 1) << (position & 7);
+  };
+
+  put(1 << 6, 7);
+  for (int c = 0; c < 4; c++)
+  {
+    put(q[0][c], 7);
+    put(q[1][c], 7);
+  }
+  put(p[0], 1);
+  put(p[1], 1);
+
+  put(index[0], 3);
+  for (int i = 1; i < 16; i++) put(index[i], 4);
+}
@@ -0,0 +1,104 @@
+/**
+ * AtomicTexture 0.1
+ *
+ * CPU texture pipeline: decode once, build the sRGB-correct mip chain (SSE2 /
+ * AVX2 box filter, rows split across the job pool), encode it to BC1 (opaque)
+ * or BC7 (with alpha) and keep it in a KTX2-style container (format, extent,
+ * level index) cached next to the source. Later launches map the container and
+ * upload its levels as they are, with no image decode and no GPU blits.
+ */
+
+#ifndef ATOMICTEXTURE_H
+#define ATOMICTEXTURE_H
+
+#include <vulkan/vulkan.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TEXTURE_X86                 1
+#else
+#define TEXTURE_X86                 0
+#endif
+
+#define TEXTURE_CACHE_MAGIC         0x58544541 // "AETX"
+#define TEXTURE_CACHE_VERSION       1          // bump when an encoder changes
+#define TEXTURE_CACHE_EXTENSION     ".aetex"
+#define TEXTURE_MAX_LEVELS          16
+#define TEXTURE_ENCODE_GRAIN        16         // block rows per encode job
+#define TEXTURE_MIP_GRAIN           32         // destination rows per downsample job
+
+class AtomicTexture
+{
+ public:
+  struct Level { uint64_t offset, size; uint32_t width, height; };
+
+  enum Kernel { Scalar, SSE, AVX2, Auto };
+
+  VkFormat format = VK_FORMAT_UNDEFINED;
+  uint32_t width = 0, height = 0;
+  std::vector<Level> levels;
+
+  AtomicTexture () {}
+  AtomicTexture (const AtomicTexture&) = delete;
+  AtomicTexture& operator= (const AtomicTexture&) = delete;
+  ~AtomicTexture () { release(); }
+
+  // Cache hit: map the container. Miss: decode, mip, encode (block-compressed, or RGBA8), then store the container
+  bool load(const std::string &source, bool compressed, AtomicJobs &jobs);
+
+  // Mip chain + encoding from decoded RGBA8 pixels (sRGB)
+  void build(const uint8_t *rgba, uint32_t width, uint32_t height, bool compressed, AtomicJobs &jobs);
+
+  bool loadCache(const std::string &source, bool compressed);
+  bool storeCache(const std::string &source, bool compressed) const;
+
+  const uint8_t* data() const { return mapping ? (const uint8_t*) mapping + data_offset : owned.data(); }
+  size_t size() const { return levels.empty() ? 0 : (size_t) (levels.back().offset + levels.back().size); }
+  void release();
+
+  static std::string cachePath(const std::string &source, bool compressed) { return source + (compressed ? "" : ".rgba8") + TEXTURE_CACHE_EXTENSION; }
+  static uint32_t blockBytes(VkFormat format);  // per 4x4 block; 0 for uncompressed formats
+  static const char* formatName(VkFormat format);
+
+  // 2x2 box filter in linear light; alpha is averaged as is. dst: max(1, w/2) x max(1, h/2), rows [y_begin, y_end).
+  // Every kernel produces the same bytes.
+  static void downsample(const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, uint32_t y_begin, uint32_t y_end, Kernel kernel = Auto);
+  static void downsample(const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, Kernel kernel = Auto) { downsample(src, w, h, dst, 0, std::max(1u, h / 2), kernel); }
+
+  // Whole level, split into TEXTURE_MIP_GRAIN row bands on the job system
+  static void downsampleParallel(AtomicJobs &jobs, const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, Kernel kernel = Auto);
+
+  // Widest kernel this CPU (and OS) can run
+  static Kernel best();
+
+  // One 4x4 block of RGBA8 (row-major, 64 bytes) in, one block out
+  static void encodeBC1(const uint8_t *rgba, uint8_t *out);
+  static void encodeBC7(const uint8_t *rgba, uint8_t *out);
+
+ private:
+  // On-disk layout mirrors KTX2: header fields, level index, then the levels (each 16-byte aligned)
+  struct CacheHeader
+  {
+    uint32_t magic, version;
+    uint64_t source_hash, source_size;
+    int64_t  source_mtime;
+    uint32_t vk_format, pixel_width, pixel_height, level_count;
+    struct { uint64_t byte_offset, byte_length; } level_index[TEXTURE_MAX_LEVELS];
+  };
+
+  std::vector<uint8_t> owned;
+  void *mapping = nullptr;                  size_t mapping_size = 0, data_offset = 0;
+
+  static uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) & ~(a - 1); }
+
+  static void downsampleScalar(const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, uint32_t y_begin, uint32_t y_end);
+#if TEXTURE_X86
+  static void downsampleSSE(const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, uint32_t y_begin, uint32_t y_end);
+  static void downsampleAVX2(const uint8_t *src, uint32_t w, uint32_t h, uint8_t *dst, uint32_t y_begin, uint32_t y_end);
+#endif
+};
+
+#endif //ATOMICTEXTURE_H
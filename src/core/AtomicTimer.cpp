@@ -0,0 +1,43 @@
+/**
+ * AtomicTimer 0.1
+ */
+
+AtomicTimer::Handle AtomicTimer::create(const char *name, double hz)
+{
+  slots.push_back(Slot());
+  names.push_back(name);
+  setRate(slots.size() - 1, hz);
+  return slots.size() - 1;
+}
+
+AtomicTimer::Handle AtomicTimer::find(const char *name) const
+{
+  for (Handle h = 0; h < names.size(); h++)
+    if (names[h] == name) return h;
+  return invalid;
+}
+
+void AtomicTimer::setRate(Handle timer, double hz)
+{
+  slots[timer].interval = hz > 0 ? (uint64_t) (1e9 / hz) : 0;
+}
+
+bool AtomicTimer::test(Handle timer)
+{
+  Slot &slot = slots[timer];
+  uint64_t now = nowNS();
+  if (now - slot.last < slot.interval) return false;
+
+  slot.last = now;
+  return true;
+}
+
+uint64_t AtomicTimer::elapsedNS(Handle timer) const
+{
+  return nowNS() - slots[timer].last;
+}
+
+uint64_t AtomicTimer::nowNS()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,48 @@
+/**
+ * AtomicTimer 0.1
+ *
+ * Registry of rate timers on a nanosecond monotonic clock. Only registered
+ * timers take space; each is addressed by the handle returned from create().
+ */
+
+#ifndef ATOMICTIMER_H
+#define ATOMICTIMER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+class AtomicTimer
+{
+ public:
+  using Handle = uint32_t;
+  static constexpr Handle invalid = ~0u;
+
+  AtomicTimer () : epoch(nowNS()) {}
+  AtomicTimer (const AtomicTimer&) = delete;
+  AtomicTimer& operator= (const AtomicTimer&) = delete;
+
+  // Fires at most `hz` times per second; the name is for lookups and debugging only
+  Handle create(const char *name, double hz);
+  Handle find(const char *name) const;
+  void setRate(Handle timer, double hz);
+
+  bool test(Handle timer);                    // true (and re-armed) once the interval has elapsed
+  uint64_t elapsedNS(Handle timer) const;     // since the timer last fired
+
+  static uint64_t nowNS();                    // monotonic
+  uint64_t getNS() const { return nowNS() - epoch; }
+  long unsigned getMS() const { return getNS() / 1000000; }
+  long unsigned getS () const { return getNS() / 1000000000; }
+
+  size_t size() const { return slots.size(); }
+
+ private:
+  struct Slot { uint64_t last = 0, interval = 0; };  // hot: touched by test()
+
+  uint64_t epoch;
+  std::vector<Slot> slots;
+  std::vector<std::string> names;                    // cold, parallel to slots
+};
+
+#endif //ATOMICTIMER_H
@@ -0,0 +1,408 @@
+/**
+ * AtomicUpload 0.1
+ */
+
+void AtomicUpload::init(AtomicVK *g, uint32_t gfamily, VkQueue gqueue, uint32_t tfamily, VkQueue tqueue)
+{
+  gpu = g;
+  device = gpu->device;
+  graphics_family = gfamily;   graphics_queue = gqueue;
+  transfer_family = tfamily;   transfer_queue = tqueue;
+
+  // Block compression needs the feature and both formats sampleable with optimal tiling
+  compressed = gpu->textureCompressionBC;
+  for (VkFormat format : {VK_FORMAT_BC1_RGB_SRGB_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK})
+  {
+    try { gpu->findSupportedFormat({format}, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT); }
+    catch (const std::runtime_error&) { compressed = false; }
+  }
+
+  // Command pools: short-lived, individually resettable buffers
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+  poolInfo.queueFamilyIndex = graphics_family;
+  if (vkCreateCommandPool(device, &poolInfo, nullptr, &graphics_pool) != VK_SUCCESS)
+    throw std::runtime_error("failed to create upload command pool!");
+
+  if (transfer_family != graphics_family)
+  {
+    poolInfo.queueFamilyIndex = transfer_family;
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &transfer_pool) != VK_SUCCESS)
+      throw std::runtime_error("failed to create transfer command pool!");
+  }
+
+  // Staging ring, mapped for the lifetime of the device
+  gpu->createBuffer(UPLOAD_RING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, ring_buffer, ring_memory);
+  ring_data = (uint8_t*) ring_memory.mapped;
+  ring_head = 0;
+
+  // Decode workers
+  stopping = false;
+  unsigned count = std::max(1u, std::thread::hardware_concurrency() / 2);
+  for (unsigned i=0; i<count; i++)
+    workers.emplace_back(&AtomicUpload::decodeWorker, this);
+
+  if (ATOMICENGINE_DEBUG)
+    printf("Upload queue family: %u (%s), %u decode workers, %s textures\n", transfer_family, transfer_family != graphics_family ? "dedicated transfer" : "graphics", count, compressed ? "BC1/BC7" : "RGBA8");
+}
+
+void AtomicUpload::destroy()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &t : workers) t.join();
+  workers.clear();
+
+  // Drop everything still in the pipeline
+  for (auto &job : submitted)
+    vkWaitForFences(device, 1, &job->fence, VK_TRUE, UINT64_MAX);
+
+  for (auto *queue : {&decode_queue, &decoded, &waiting, &submitted})
+  {
+    for (auto &job : *queue)
+    {
+      if (job->texture.image) gpu->destroyImage(job->texture.image, job->texture.memory);
+      if (job->overflow_buffer) gpu->destroyBuffer(job->overflow_buffer, job->overflow_memory);
+      if (job->fence) vkDestroyFence(device, job->fence, nullptr);
+      if (job->semaphore) vkDestroySemaphore(device, job->semaphore, nullptr);
+    }
+    queue->clear();
+  }
+
+  for (auto f : free_fences) vkDestroyFence(device, f, nullptr);
+  for (auto s : free_semaphores) vkDestroySemaphore(device, s, nullptr);
+  free_fences.clear();         free_semaphores.clear();
+  free_graphics_cmds.clear();  free_transfer_cmds.clear();
+
+  if (graphics_pool) vkDestroyCommandPool(device, graphics_pool, nullptr);
+  if (transfer_pool) vkDestroyCommandPool(device, transfer_pool, nullptr);
+  graphics_pool = transfer_pool = VK_NULL_HANDLE;
+
+  if (ring_buffer) gpu->destroyBuffer(ring_buffer, ring_memory);
+  ring_buffer = VK_NULL_HANDLE;  ring_data = nullptr;
+}
+
+void AtomicUpload::loadTexture(const std::string &path, std::function<void(const Texture&)> ready, uint32_t max_extent)
+{
+  auto job = std::make_unique<Job>();
+  job->path = path;
+  job->ready = std::move(ready);
+  job->max_extent = max_extent;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    decode_queue.push_back(std::move(job));
+  }
+  wake.notify_one();
+}
+
+bool AtomicUpload::busy()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return !decode_queue.empty() || !decoded.empty() || !waiting.empty() || !submitted.empty();
+}
+
+void AtomicUpload::callback()
+{
+  // Collect decoded images
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!decoded.empty())
+    {
+      waiting.push_back(std::move(decoded.front()));
+      decoded.pop_front();
+    }
+  }
+
+  // Submit in order until the staging ring is full
+  while (!waiting.empty() && submit(*waiting.front()))
+  {
+    submitted.push_back(std::move(waiting.front()));
+    waiting.pop_front();
+  }
+
+  // Retire finished uploads in submission order, releasing their ring space
+  while (!submitted.empty() && vkGetFenceStatus(device, submitted.front()->fence) == VK_SUCCESS)
+  {
+    retire(*submitted.front());
+    submitted.pop_front();
+  }
+}
+
+void AtomicUpload::decodeWorker()
+{
+  for (;;)
+  {
+    std::unique_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this]() { return stopping || !decode_queue.empty(); });
+      if (stopping) return;
+
+      job = std::move(decode_queue.front());
+      decode_queue.pop_front();
+    }
+
+    // Cache hit maps the encoded levels; a miss encodes them (fanned out on the engine's job pool) and stores them
+    job->loaded = job->image.load(job->path, compressed, gpu->engine->jobs);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    decoded.push_back(std::move(job));
+  }
+}
+
+bool AtomicUpload::submit(Job &job)
+{
+  if (!job.loaded)
+    throw std::runtime_error("failed to load texture image: " + job.path);
+
+  // Partial load: skip the levels larger than requested; the rest stay contiguous
+  const std::vector<AtomicTexture::Level> &levels = job.image.levels;
+  uint32_t first = 0;
+  while (first + 1 < levels.size() && std::max(levels[first].width, levels[first].height) > job.max_extent) first++;
+
+  const uint8_t *data = job.image.data() + levels[first].offset;
+  VkDeviceSize size = job.image.size() - levels[first].offset;
+  VkBuffer staging = ring_buffer;
+
+  // Stage: ring slice, or a one-off buffer for images larger than the whole ring
+  if (size > UPLOAD_RING_SIZE)
+  {
+    gpu->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, job.overflow_buffer, job.overflow_memory);
+
+    memcpy(job.overflow_memory.mapped, data, (size_t) size);
+
+    staging = job.overflow_buffer;
+    job.ring_offset = 0;
+  }
+  else
+  {
+    if (!ringAlloc(size, job.ring_offset)) return false;
+    job.ring_size = size;
+    memcpy(ring_data + job.ring_offset, data, (size_t) size);
+  }
+
+  // Every level comes precomputed: one copy region each, no blits
+  std::vector<VkBufferImageCopy> regions(levels.size() - first);
+  for (size_t l = 0; l < regions.size(); l++)
+  {
+    const AtomicTexture::Level &level = levels[first + l];
+    regions[l].bufferOffset = job.ring_offset + level.offset - levels[first].offset;
+    regions[l].imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, (uint32_t) l, 0, 1 };
+    regions[l].imageExtent = { level.width, level.height, 1 };
+  }
+
+  Texture &t = job.texture;
+  t.width = levels[first].width;
+  t.height = levels[first].height;
+  t.format = job.image.format;
+  t.mipLevels = (uint32_t) regions.size();
+  t.baseLevel = first;
+  t.chainWidth = job.image.width;
+  t.chainHeight = job.image.height;
+  t.chainLevels = (uint32_t) levels.size();
+
+  job.image.release();
+
+  bool dedicated = transfer_family != graphics_family;
+  std::vector<uint32_t> families = { graphics_family };
+  if (dedicated) families.push_back(transfer_family);
+
+  gpu->createImage(t.width, t.height, t.mipLevels, VK_SAMPLE_COUNT_1_BIT, t.format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, t.image, t.memory, families);
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  // Copy: all levels to TRANSFER_DST, buffer -> every level
+  VkCommandBuffer copy_cmd = dedicated ? (job.transfer_cmd = acquireCommandBuffer(transfer_pool, free_transfer_cmds))
+                                       : (job.graphics_cmd = acquireCommandBuffer(graphics_pool, free_graphics_cmds));
+  vkBeginCommandBuffer(copy_cmd, &beginInfo);
+
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = t.image;
+  barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, t.mipLevels, 0, 1 };
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(copy_cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+  vkCmdCopyBufferToImage(copy_cmd, staging, t.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t) regions.size(), regions.data());
+
+  // TRANSFER_DST -> SHADER_READ_ONLY; a transfer-only queue has no fragment stage, so it is recorded on graphics
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+  // Shared graphics queue: the transition goes into the same submission
+  if (!dedicated) vkCmdPipelineBarrier(copy_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+  vkEndCommandBuffer(copy_cmd);
+
+  job.fence = acquireFence();
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &copy_cmd;
+
+  if (!dedicated)
+  {
+    if (vkQueueSubmit(graphics_queue, 1, &submitInfo, job.fence) != VK_SUCCESS)
+      throw std::runtime_error("failed to submit texture upload!");
+    return true;
+  }
+
+  // Dedicated transfer queue: the final transition runs on graphics, chained through a semaphore
+  job.semaphore = acquireSemaphore();
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores = &job.semaphore;
+
+  if (vkQueueSubmit(transfer_queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    throw std::runtime_error("failed to submit texture transfer!");
+
+  job.graphics_cmd = acquireCommandBuffer(graphics_pool, free_graphics_cmds);
+  vkBeginCommandBuffer(job.graphics_cmd, &beginInfo);
+  vkCmdPipelineBarrier(job.graphics_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+  vkEndCommandBuffer(job.graphics_cmd);
+
+  VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  VkSubmitInfo layoutInfo{};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  layoutInfo.waitSemaphoreCount = 1;
+  layoutInfo.pWaitSemaphores = &job.semaphore;
+  layoutInfo.pWaitDstStageMask = &waitStage;
+  layoutInfo.commandBufferCount = 1;
+  layoutInfo.pCommandBuffers = &job.graphics_cmd;
+
+  if (vkQueueSubmit(graphics_queue, 1, &layoutInfo, job.fence) != VK_SUCCESS)
+    throw std::runtime_error("failed to submit texture layout transition!");
+
+  return true;
+}
+
+void AtomicUpload::retire(Job &job)
+{
+  job.texture.view = gpu->createImageView(job.texture.image, job.texture.format, VK_IMAGE_ASPECT_COLOR_BIT, job.texture.mipLevels);
+
+  if (ATOMICENGINE_DEBUG)
+    printf("Streamed texture: %s (%s, %ux%u, levels %u-%u of %u)\n", job.path.c_str(), AtomicTexture::formatName(job.texture.format), job.texture.width, job.texture.height,
+           job.texture.baseLevel, job.texture.baseLevel + job.texture.mipLevels - 1, job.texture.chainLevels);
+
+  // Ownership of the image passes to the receiver
+  if (job.ready) job.ready(job.texture);
+  job.texture = Texture();
+
+  vkResetFences(device, 1, &job.fence);
+  free_fences.push_back(job.fence);
+  job.fence = VK_NULL_HANDLE;
+
+  if (job.semaphore) free_semaphores.push_back(job.semaphore);
+  if (job.transfer_cmd) free_transfer_cmds.push_back(job.transfer_cmd);
+  if (job.graphics_cmd) free_graphics_cmds.push_back(job.graphics_cmd);
+  job.semaphore = VK_NULL_HANDLE;
+
+  if (job.overflow_buffer)
+  {
+    gpu->destroyBuffer(job.overflow_buffer, job.overflow_memory);
+    job.overflow_buffer = VK_NULL_HANDLE;
+  }
+}
+
+bool AtomicUpload::ringAlloc(VkDeviceSize size, VkDeviceSize &offset)
+{
+  // Oldest ring slice still in flight marks the tail
+  const Job *oldest = nullptr;
+  for (const auto &job : submitted)
+    if (job->ring_size) { oldest = job.get(); break; }
+
+  if (!oldest) ring_head = 0;
+
+  VkDeviceSize head = (ring_head + UPLOAD_RING_ALIGNMENT - 1) & ~(VkDeviceSize) (UPLOAD_RING_ALIGNMENT - 1);
+
+  if (!oldest)
+    offset = 0;
+  else if (oldest->ring_offset < ring_head)
+  {
+    // [tail, head) in use: room at the end, or wrap to the start
+    if (head + size <= UPLOAD_RING_SIZE) offset = head;
+    else if (size <= oldest->ring_offset) offset = 0;
+    else return false;
+  }
+  else
+  {
+    // Wrapped: [head, tail) is free
+    if (head + size <= oldest->ring_offset) offset = head;
+    else return false;
+  }
+
+  ring_head = offset + size;
+  return true;
+}
+
+VkCommandBuffer AtomicUpload::acquireCommandBuffer(VkCommandPool pool, std::vector<VkCommandBuffer> &free_list)
+{
+  if (!free_list.empty())
+  {
+    VkCommandBuffer cmd = free_list.back();
+    free_list.pop_back();
+    return cmd;
+  }
+
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool = pool;
+  allocInfo.commandBufferCount = 1;
+
+  VkCommandBuffer cmd;
+  if (vkAllocateCommandBuffers(device, &allocInfo, &cmd) != VK_SUCCESS)
+    throw std::runtime_error("failed to allocate upload command buffer!");
+  return cmd;
+}
+
+VkFence AtomicUpload::acquireFence()
+{
+  if (!free_fences.empty())
+  {
+    VkFence fence = free_fences.back();
+    free_fences.pop_back();
+    return fence;
+  }
+
+  VkFenceCreateInfo fenceInfo{};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+  VkFence fence;
+  if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+    throw std::runtime_error("failed to create upload fence!");
+  return fence;
+}
+
+VkSemaphore AtomicUpload::acquireSemaphore()
+{
+  if (!free_semaphores.empty())
+  {
+    VkSemaphore semaphore = free_semaphores.back();
+    free_semaphores.pop_back();
+    return semaphore;
+  }
+
+  VkSemaphoreCreateInfo semaphoreInfo{};
+  semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+  VkSemaphore semaphore;
+  if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+    throw std::runtime_error("failed to create upload semaphore!");
+  return semaphore;
+}
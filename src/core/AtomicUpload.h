@@ -0,0 +1,97 @@
+/**
+ * AtomicUpload 0.1
+ *
+ * Asynchronous texture streaming: load (cached, block-compressed, all mips) on
+ * worker threads, copy through a persistently mapped staging ring on the
+ * transfer queue, fence per resource.
+ */
+
+#ifndef ATOMICUPLOAD_H
+#define ATOMICUPLOAD_H
+
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+#define UPLOAD_RING_SIZE            (64ull << 20)
+#define UPLOAD_RING_ALIGNMENT       16
+
+class AtomicVK;
+
+class AtomicUpload
+{
+ public:
+  struct Texture
+  {
+    VkImage image = VK_NULL_HANDLE;         AtomicMemory::Allocation memory;
+    VkImageView view = VK_NULL_HANDLE;      VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0, height = 0, mipLevels = 1;
+    uint32_t baseLevel = 0;                 // chain level at mip 0 (partial loads)
+    uint32_t chainWidth = 0, chainHeight = 0, chainLevels = 1;
+  };
+
+  AtomicUpload () {}
+  AtomicUpload (const AtomicUpload&) = delete;
+  AtomicUpload& operator= (const AtomicUpload&) = delete;
+
+  void init(AtomicVK *gpu, uint32_t graphics_family, VkQueue graphics_queue, uint32_t transfer_family, VkQueue transfer_queue);
+  void destroy();
+
+  // Queue a texture; ready() runs on the calling thread from callback() once it can be sampled.
+  // Only the levels no larger than max_extent (at least the last one) go into the image.
+  void loadTexture(const std::string &path, std::function<void(const Texture&)> ready, uint32_t max_extent = ~0u);
+
+  void callback();
+  bool busy();
+
+ private:
+  struct Job
+  {
+    std::string path;                       std::function<void(const Texture&)> ready;
+    AtomicTexture image;                    bool loaded = false;
+    uint32_t max_extent = ~0u;
+    Texture texture;
+
+    VkCommandBuffer transfer_cmd = VK_NULL_HANDLE, graphics_cmd = VK_NULL_HANDLE;
+    VkSemaphore semaphore = VK_NULL_HANDLE; VkFence fence = VK_NULL_HANDLE;
+
+    VkDeviceSize ring_offset = 0, ring_size = 0;
+    VkBuffer overflow_buffer = VK_NULL_HANDLE; AtomicMemory::Allocation overflow_memory;
+  };
+
+  AtomicVK *gpu = nullptr;                  VkDevice device = VK_NULL_HANDLE;
+  uint32_t graphics_family = 0;             VkQueue graphics_queue = VK_NULL_HANDLE;
+  uint32_t transfer_family = 0;             VkQueue transfer_queue = VK_NULL_HANDLE;
+  bool compressed = false;                  // BC1/BC7 sampled by the device, else RGBA8
+  VkCommandPool graphics_pool = VK_NULL_HANDLE, transfer_pool = VK_NULL_HANDLE;
+
+  // Staging ring: [tail, head) is in flight, released in submission order
+  VkBuffer ring_buffer = VK_NULL_HANDLE;    AtomicMemory::Allocation ring_memory;
+  uint8_t *ring_data = nullptr;             VkDeviceSize ring_head = 0;
+
+  // Recycled per-submission objects
+  std::vector<VkCommandBuffer> free_graphics_cmds, free_transfer_cmds;
+  std::vector<VkSemaphore> free_semaphores; std::vector<VkFence> free_fences;
+
+  // Decode workers
+  std::vector<std::thread> workers;         bool stopping = false;
+  std::mutex mutex;                         std::condition_variable wake;
+  std::deque<std::unique_ptr<Job>> decode_queue, decoded;
+
+  // Main thread only
+  std::deque<std::unique_ptr<Job>> waiting, submitted;
+
+  void decodeWorker();
+  bool submit(Job &job);
+  void retire(Job &job);
+
+  bool ringAlloc(VkDeviceSize size, VkDeviceSize &offset);
+  VkCommandBuffer acquireCommandBuffer(VkCommandPool pool, std::vector<VkCommandBuffer> &free_list);
+  VkFence acquireFence();
+  VkSemaphore acquireSemaphore();
+};
+
+#endif //ATOMICUPLOAD_H
@@ -7,7 +7,8 @@
  */
 
 char window_title[0x7F];
-unsigned int c_frame, fps, frame_cap=65;
+std::atomic<unsigned> c_frame{0};
+unsigned int fps;
 
 char *load_model = "../textures/alduin.obj",
      *load_texture = "../textures/alduin.jpg";
@@ -17,31 +18,38 @@ struct AtomicVK::VkQueueFamilyIndices
 {
   std::optional<uint32_t> graphicsFamily;
   std::optional<uint32_t> presentFamily;
+  std::optional<uint32_t> transferFamily; // dedicated (non-graphics) transfer family, if any
   bool completed() { return graphicsFamily.has_value() && presentFamily.has_value(); }
 };
 
+// Simulation thread: hand the frame to the render thread, then service the window
 void AtomicVK::callback ()
 {
   if (status>=5)
   {
-    // Increment FPS counter
-    if (engine->timer.test(frame_cap, TIMER_FPS+0))
+    if (render_failed)
     {
-      draw();
-      c_frame++;
+      stopRenderThread();
+      std::rethrow_exception(render_error);
     }
 
-    // Reset FPS counter
-    if (engine->timer.test(1, TIMER_FPS+1))
+    // Shader hot-reload
+    if (SHADER_HOT_RELOAD && engine->timer.test(shader_timer))
     {
-      fps = c_frame;
-      c_frame = 0;
+      std::lock_guard<std::mutex> lock(gpu_mutex);
+      reloadShaders();
     }
 
+    publishFrame();
+
+    // Reset FPS counter (frames actually rendered)
+    if (engine->timer.test(fps_timer))
+      fps = c_frame.exchange(0);
+
     // Update Window Title
-    if(engine->timer.test(60, TIMER_FPS+2))
+    if (engine->timer.test(title_timer))
     {
-      snprintf(window_title, sizeof(window_title), "FPS: %ld | FPS CAP: %ld | Scale: %.3f | Time MS: %llu", fps, frame_cap, test_scale, engine->timer.getMS());
+      snprintf(window_title, sizeof(window_title), "FPS: %u | FPS CAP: %u | Scale: %.3f | Instances: %u/%u | Draw: %.3f ms | Time MS: %lu", fps, frame_cap, test_scale, visible_instances.load(), test_instances, draw_ns / 1e6, engine->timer.getMS());
       glfwSetWindowTitle(window, window_title);
     }
   }
@@ -49,21 +57,129 @@ void AtomicVK::callback ()
   if (!glfwWindowShouldClose(window))
     glfwPollEvents();
 
-  // Exit GPU
-  else status = 3;
+  // Exit GPU: the render thread is the only queue user, so idle the device only once it has stopped
+  else
+  {
+    status = 3;
+    stopRenderThread();
+    vkDeviceWaitIdle(device);
+  }
+}
+
+// Snapshot the simulated state into the next frame packet
+void AtomicVK::publishFrame()
+{
+  AtomicFrame &frame = frames.back();
+  frame.tick++;
+  frame.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+  frame.camera_view = frame.view;
+
+  float angle = glm::mix(model_angle_prev, model_angle, (float) interpolation);
+  glm::mat4 spin = glm::rotate(glm::mat4(1.2f), angle, glm::vec3(0.5f, 0.5f, 1.0f));
+
+  // Lay the copies out on a square grid that keeps the same footprint as a single model
+  unsigned count = std::clamp(test_instances, 1u, (unsigned) SCENE_MAX_INSTANCES);
+  unsigned side = (unsigned) std::ceil(std::sqrt((double) count));
+  float cell = 2.0f / side, scale = test_scale / side;
+
+  frame.instances.resize(count);
+  for (unsigned n = 0; n < count; n++)
+  {
+    glm::vec3 position(((n % side) + 0.5f) * cell - 1.0f, ((n / side) + 0.5f) * cell - 1.0f, 0.0f);
+
+    AtomicScene::Instance &instance = frame.instances[n];
+    instance.model = glm::scale(glm::translate(glm::mat4(1.0f), position) * glm::mat4(scale), glm::vec3(scale)) * spin;
+    instance.mesh = 0;
+    instance.texture = streamedTexture;
+  }
+
+  frames.publish();
+
+  // Empty critical section: orders the publish against the render thread's predicate check
+  { std::lock_guard<std::mutex> lock(frame_mutex); }
+  frame_cv.notify_one();
+}
+
+void AtomicVK::startRenderThread()
+{
+  if (render_thread.joinable()) return;
+
+  render_running = true;
+  render_thread = std::thread(&AtomicVK::renderLoop, this);
+}
+
+void AtomicVK::stopRenderThread()
+{
+  if (!render_thread.joinable()) return;
 
-  if (status>2) vkDeviceWaitIdle(device);
+  {
+    std::lock_guard<std::mutex> lock(frame_mutex);
+    render_running = false;
+  }
+  frame_cv.notify_one();
+  render_thread.join();
+}
+
+// Render thread: owns fence waits, submission and present; blocks only on its own GPU work
+void AtomicVK::renderLoop()
+{
+  try
+  {
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(frame_mutex);
+        frame_cv.wait(lock, [this] { return !render_running || frames.fresh(); });
+        if (!render_running) break;
+      }
+      frames.fetch();
+
+      std::lock_guard<std::mutex> lock(gpu_mutex);
+
+      // Stream assets
+      upload.callback();
+      collectSetup();
+
+      uint64_t draw_start = AtomicTimer::nowNS();
+      draw(frames.front());
+      draw_ns = AtomicTimer::nowNS() - draw_start;
+      c_frame++;
+    }
+  }
+  catch (...)
+  {
+    // Rethrown on the simulation thread by callback()
+    render_error = std::current_exception();
+    render_failed = true;
+  }
+}
+
+void AtomicVK::initTimers()
+{
+  fps_timer    = engine->timer.create("gpu.fps", 1);
+  title_timer  = engine->timer.create("gpu.title", 60);
+  shader_timer = engine->timer.create("gpu.shader_reload", 10);
+}
+
+// Fixed-timestep simulation; rendering interpolates between the last two steps
+void AtomicVK::simulate(double dt)
+{
+  model_angle_prev = model_angle;
+  model_angle += (float) dt * glm::radians(-10.0f);
 }
 
 void AtomicVK::reload()
 {
-  initVulkan(1);
+  std::lock_guard<std::mutex> lock(gpu_mutex);
+  vkDeviceWaitIdle(device);
+  initAssets(true);
 }
 
 void AtomicVK::exit()
 {
   status = 2;
 
+  stopRenderThread();
   destroyVulkan();
   destroyScreen();
 
@@ -72,6 +188,53 @@ void AtomicVK::exit()
 
 void AtomicVK::loadModel()
 {
+  vertices.clear();
+  indices.clear();
+  meshMin = meshMax = glm::vec3(0.0f);
+
+  // glTF: accessor spans are encoded straight into the staging buffers, quantized by the POSITION bounds
+  if (AtomicGLTF::isGLTF(load_model))
+  {
+    auto asset = std::make_shared<AtomicGLTF::Asset>();
+    asset->load(load_model);
+
+    uint32_t vertex_total = 0, index_total = 0;
+    for (const auto &m : asset->meshes)
+      for (const auto &p : m.primitives)
+        if (p.mode == GLTF_MODE_TRIANGLES)
+        {
+          glm::vec3 min, max;
+          asset->bounds(p, min, max);
+          meshMin = vertex_total ? glm::min(meshMin, min) : min;
+          meshMax = vertex_total ? glm::max(meshMax, max) : max;
+          vertex_total += asset->vertexCount(p);
+          index_total += asset->indexCount(p);
+        }
+
+    meshQuantization = AtomicVertex::quantization<GPUVertex>(meshMin, meshMax);
+    mesh.assign(nullptr, vertex_total, sizeof(GPUVertex), nullptr, index_total);
+
+    mesh.write_vertices = [asset, quantization = meshQuantization](void *dst) {
+      GPUVertex *v = (GPUVertex*) dst;
+      for (const auto &m : asset->meshes)
+        for (const auto &p : m.primitives)
+          if (p.mode == GLTF_MODE_TRIANGLES) v += asset->packVertices(p, quantization, v);
+    };
+
+    mesh.write_indices = [asset](void *dst) {
+      uint32_t *i = (uint32_t*) dst, base = 0;
+      for (const auto &m : asset->meshes)
+        for (const auto &p : m.primitives)
+          if (p.mode == GLTF_MODE_TRIANGLES) { i += asset->packIndices(p, base, i); base += asset->vertexCount(p); }
+    };
+
+    return;
+  }
+
+  // Warm start: map the welded mesh straight from the binary cache
+  if (_load_model && mesh.loadCache(load_model, sizeof(Vertex)))
+    return;
+
   tinyobj::attrib_t attrib;
   std::vector<tinyobj::shape_t> shapes;
   std::vector<tinyobj::material_t> materials;
@@ -81,43 +244,79 @@ void AtomicVK::loadModel()
     throw std::runtime_error(warn + err);
   }
 
-  std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+  // Split shapes (and large shapes into triangle-aligned ranges) across the job pool
+  unsigned workers = engine->jobs.threads();
+  size_t index_total = 0;
+  for (const auto& shape : shapes) index_total += shape.mesh.indices.size();
 
-  for (const auto& shape : shapes) {
-    for (const auto& index : shape.mesh.indices) {
-      Vertex vertex{};
+  size_t chunk_size = std::max<size_t>(MESH_WELD_CHUNK_MIN, index_total / (workers * 4));
+  chunk_size -= chunk_size % 3;
 
-      if (_load_model)
-        vertex.pos = {
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2]
-        };
-      else
-        vertex.pos = {0, 0, 0};
+  std::vector<std::span<const tinyobj::index_t>> chunks;
+  for (const auto& shape : shapes)
+  {
+    std::span<const tinyobj::index_t> all(shape.mesh.indices);
+    for (size_t offset = 0; offset < all.size(); offset += chunk_size)
+      chunks.push_back(all.subspan(offset, std::min(chunk_size, all.size() - offset)));
+  }
 
-      if (_load_model && (int) sizeof(attrib.texcoords) <= (int) 2 * index.texcoord_index + 1)
-        vertex.texCoord = {
-                attrib.texcoords[2 * index.texcoord_index + 0],
-                1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-        };
-      else
-        vertex.texCoord = {0, 0};
+  // Weld on the (vertex, texcoord, normal) tuple, then on identical vertex bytes
+  AtomicMesh::weldParallel(engine->jobs, chunks, [&](const tinyobj::index_t &index)
+  {
+    Vertex vertex = objVertex(attrib, {index.vertex_index, index.texcoord_index, index.normal_index});
+    if (!_load_model) vertex.pos = {0, 0, 0}, vertex.normal = {0, 0, 0}, vertex.texCoord = {0, 0};
+    return vertex;
+  }, vertices, indices);
 
-      vertex.color = {1.0f, 0.0f, 0.0f};
+  mesh.assign(vertices.data(), static_cast<uint32_t>(vertices.size()), sizeof(Vertex), indices.data(), static_cast<uint32_t>(indices.size()));
 
-      if (uniqueVertices.count(vertex) == 0) {
-        uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-        vertices.push_back(vertex);
-      }
+  // Cold start: write the cache keyed on the source path, size and mtime
+  if (_load_model && !mesh.storeCache(load_model) && ATOMICENGINE_DEBUG)
+    printf("Unable to write mesh cache: %s\n", AtomicMesh::cachePath(load_model).c_str());
+}
 
-      indices.push_back(uniqueVertices[vertex]);
-    }
-  }
+AtomicVK::Vertex AtomicVK::objVertex(const tinyobj::attrib_t &attrib, const AtomicMesh::ObjIndex &index)
+{
+  Vertex vertex{};
+
+  vertex.pos = {
+          attrib.vertices[3 * index.vertex + 0],
+          attrib.vertices[3 * index.vertex + 1],
+          attrib.vertices[3 * index.vertex + 2]
+  };
+
+  if (index.texcoord >= 0)
+    vertex.texCoord = {
+            attrib.texcoords[2 * index.texcoord + 0],
+            1.0f - attrib.texcoords[2 * index.texcoord + 1]
+    };
+  else
+    vertex.texCoord = {0, 0};
+
+  if (index.normal >= 0)
+    vertex.normal = {
+            attrib.normals[3 * index.normal + 0],
+            attrib.normals[3 * index.normal + 1],
+            attrib.normals[3 * index.normal + 2]
+    };
+  else
+    vertex.normal = {0, 0, 0};
+
+  // The welder compares bytes: fold -0.0f into +0.0f so they still weld, as operator== did
+  vertex.pos += 0.0f; vertex.texCoord += 0.0f; vertex.normal += 0.0f;
+
+  return vertex;
 }
 
-void AtomicVK::draw()
+void AtomicVK::draw(const AtomicFrame &frame)
 {
+  // Minimized: nothing to present until the window has an area again
+  if (swapchainStale)
+  {
+    recreateSwapChain();
+    if (swapchainStale) return;
+  }
+
   vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
 
   uint32_t imageIndex;
@@ -130,13 +329,21 @@ void AtomicVK::draw()
     throw std::runtime_error("failed to acquire swap chain image!");
   }
 
-  updateUniformBuffer(imageIndex);
-
   if (imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
     vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
   }
   imagesInFlight[imageIndex] = inFlightFences[currentFrame];
 
+  // This slot's fence covers frame frameNumber - MAX_FRAMES_IN_FLIGHT, so every frame before the next one has retired:
+  // textures replaced since then, and their bindless slots, are no longer read
+  uint64_t retired = frameNumber + 1 >= (uint64_t) MAX_FRAMES_IN_FLIGHT ? frameNumber + 1 - MAX_FRAMES_IN_FLIGHT : 0;
+  destroyRetiredTextures(retired);
+  bindless.collect(retired);
+
+  // Uniforms go into this frame's ring slice (its fence was waited on above), bound by dynamic offset
+  uniformCursor = 0;
+  recordCommandBuffer(imageIndex, frame);
+
   VkSubmitInfo submitInfo{};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
@@ -158,6 +365,7 @@ void AtomicVK::draw()
   if (vkQueueSubmit(graphics_queue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
     throw std::runtime_error("failed to submit draw command buffer!");
   }
+  frameNumber++;
 
   VkPresentInfoKHR presentInfo{};
   presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -183,34 +391,13 @@ void AtomicVK::draw()
   currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
-void AtomicVK::initVulkan(bool recreate)
+// Device lifetime: instance, device, pools, layouts, pipelines, sync objects, placeholder texture
+void AtomicVK::initVulkan()
 {
-  if (ATOMICENGINE_DEBUG && !recreate)
-  {
-    printf("\nSPIR-V Compiled Shaders:\n");
-    system("glslangValidator -e main -o /Users/chester/Documents/Me/AtomicEngine/src/shaders/spirv/shader.frag.spv -V /Users/chester/Documents/Me/AtomicEngine/src/shaders/shader.frag.glsl  &&\n"
-           "glslangValidator -e main -o /Users/chester/Documents/Me/AtomicEngine/src/shaders/spirv/shader.vert.spv -V /Users/chester/Documents/Me/AtomicEngine/src/shaders/shader.vert.glsl");
-  }
-
   if (validation_layers_enabled && !VkVLValidate())
     throw std::runtime_error("Requested validation layers are unavailable");
 
-  // Recreate Window & Swap Chain
-  if (recreate)
-  {
-    int width = 0, height = 0;
-    glfwGetFramebufferSize(window, &width, &height);
-    while (width == 0 || height == 0) {
-      glfwGetFramebufferSize(window, &width, &height);
-      glfwWaitEvents();
-    }
-
-    vkDeviceWaitIdle(device);
-    cleanSwapChain();
-  }
-
   // Create VK instance
-  if (!recreate)
   {
     VkApplicationInfo appInfo = {};
     appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -218,7 +405,7 @@ void AtomicVK::initVulkan(bool recreate)
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "AtomicEngine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_2;
 
     VkInstanceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -260,7 +447,6 @@ void AtomicVK::initVulkan(bool recreate)
   }
 
   // Load VK extensions
-  if (!recreate)
   {
     // List extensions
     uint32_t extension_count = 0;
@@ -285,7 +471,7 @@ void AtomicVK::initVulkan(bool recreate)
   }
 
   // Init Debug Messenger
-  if (!recreate && validation_layers_enabled)
+  if (validation_layers_enabled)
   {
     VkDebugUtilsMessengerCreateInfoEXT createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
@@ -300,14 +486,12 @@ void AtomicVK::initVulkan(bool recreate)
   }
 
   // Init Surface
-  if (!recreate)
   {
     if (glfwCreateWindowSurface(instance, window, pAllocator, &surface) != VK_SUCCESS)
       throw std::runtime_error("Surface creation failed");
   }
 
   // Init Physical Device
-  if (!recreate)
   {
     uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
@@ -333,12 +517,12 @@ void AtomicVK::initVulkan(bool recreate)
   }
 
   // Init Logical Device
-  if (!recreate)
   {
     VkQueueFamilyIndices indices = VkFindQueueFamilies(physical_device);
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+    if (indices.transferFamily.has_value()) uniqueQueueFamilies.insert(indices.transferFamily.value());
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -350,10 +534,29 @@ void AtomicVK::initVulkan(bool recreate)
       queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // Indirect drawing: one multi-draw per batch, instances addressed through firstInstance
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physical_device, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures{};
+    deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    multiDrawIndirect = deviceFeatures.multiDrawIndirect;
+    indirectFirstInstance = deviceFeatures.drawIndirectFirstInstance;
+
+    // Block-compressed textures (BC1/BC7); without it the texture cache holds RGBA8
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    textureCompressionBC = deviceFeatures.textureCompressionBC;
+
+    // Bindless textures: arrays indexed per instance, updated while frames are in flight (VkDeviceValidate checked them)
+    deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+    VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+    AtomicBindless::enable(indexingFeatures);
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &indexingFeatures;
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -374,9 +577,199 @@ void AtomicVK::initVulkan(bool recreate)
 
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphics_queue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &present_queue);
+    vkGetDeviceQueue(device, indices.transferFamily.value_or(indices.graphicsFamily.value()), 0, &transfer_queue);
+
+    allocator.init(physical_device, device);
+    shaders.init(device);
+  }
+
+  // Init Command Pool
+  {
+    VkQueueFamilyIndices queueFamilyIndices = VkFindQueueFamilies(physical_device);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create graphics command pool!");
+    }
+
+    // Setup batches: short-lived, individually resettable
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &setupPool) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create setup command pool!");
+    }
+
+    // Secondary recording: one transient pool per (frame in flight, batch), so batches record without locking
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    secondaryBatches = engine->jobs.threads();
+    secondaryPools.resize(MAX_FRAMES_IN_FLIGHT * secondaryBatches);
+
+    for (auto &secondary : secondaryPools)
+    {
+      if (vkCreateCommandPool(device, &poolInfo, nullptr, &secondary.pool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create secondary command pool!");
+
+      VkCommandBufferAllocateInfo allocInfo{};
+      allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      allocInfo.commandPool = secondary.pool;
+      allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+      allocInfo.commandBufferCount = 1;
+
+      if (vkAllocateCommandBuffers(device, &allocInfo, &secondary.cmd) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate secondary command buffer!");
+    }
+
+    upload.init(this,
+                queueFamilyIndices.graphicsFamily.value(), graphics_queue,
+                queueFamilyIndices.transferFamily.value_or(queueFamilyIndices.graphicsFamily.value()), transfer_queue);
+  }
+
+  // Init Descriptor Set Layout
+  {
+    VkDescriptorSetLayoutBinding uboLayoutBinding{};
+    uboLayoutBinding.binding = 0;
+    uboLayoutBinding.descriptorCount = 1;
+    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    uboLayoutBinding.pImmutableSamplers = nullptr;
+    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutBinding instanceLayoutBinding{};
+    instanceLayoutBinding.binding = 2;
+    instanceLayoutBinding.descriptorCount = 1;
+    instanceLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    instanceLayoutBinding.pImmutableSamplers = nullptr;
+    instanceLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutBinding meshLayoutBinding{};
+    meshLayoutBinding.binding = 3;
+    meshLayoutBinding.descriptorCount = 1;
+    meshLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    meshLayoutBinding.pImmutableSamplers = nullptr;
+    meshLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    // Textures are not here: they live in the bindless set (set 1), so this layout never changes with them
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings = {uboLayoutBinding, instanceLayoutBinding, meshLayoutBinding};
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create descriptor set layout!");
+    }
+  }
+
+  // Init Bindless Textures: set 1, one for the device lifetime
+  bindless.init(physical_device, device);
+
+  // Init Pipeline Cache
+  loadPipelineCache();
+
+  // Init Render Pass, Graphics Pipeline: kept across resizes, rebuilt only if the surface format changes
+  {
+    swapchain_image_format = chooseSwapSurfaceFormat(querySwapChainSupport(physical_device).formats).format;
+    createRenderPass();
+    createGraphicsPipeline();
+
+    pipelineSources.push_back({&graphicsPipeline, {"shader.vert", "shader.frag"}, &AtomicVK::buildGraphicsPipeline});
   }
 
-  // Init Swap Chain {{{RECREATE}}}
+  // Create Semaphores
+  {
+    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+      if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
+          vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
+          vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+        throw std::runtime_error("failed to create synchronization objects for a frame!");
+    }
+  }
+
+  // Init Uniform Ring: one persistently mapped region per frame in flight
+  {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    uniformAlignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 16);
+
+    createBuffer(UNIFORM_RING_FRAME_SIZE * MAX_FRAMES_IN_FLIGHT,
+                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 uniformRing,
+                 uniformRingMemory);
+  }
+
+  // Init Instance Rings: instance records and indirect commands, rewritten by the render thread each frame
+  {
+    createBuffer(sizeof(AtomicScene::InstanceData) * SCENE_MAX_INSTANCES * MAX_FRAMES_IN_FLIGHT,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 instanceRing,
+                 instanceRingMemory);
+
+    createBuffer(sizeof(VkDrawIndexedIndirectCommand) * SCENE_MAX_MESHES * MAX_FRAMES_IN_FLIGHT,
+                 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 indirectRing,
+                 indirectRingMemory);
+
+    createBuffer(sizeof(AtomicScene::MeshData) * SCENE_MAX_MESHES,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 meshBuffer,
+                 meshBufferMemory);
+
+    indirectCommands.resize(SCENE_MAX_MESHES);
+    visibleInstances.resize(SCENE_MAX_INSTANCES);
+  }
+
+  // Init Texture Images: 1x1 placeholder, bindless slot 0, sampled by every texture until it is resident
+  {
+    const uint32_t texel = 0xFFFFFFFF;
+    VkDeviceSize imageSize = sizeof(texel);
+
+    VkBuffer stagingBuffer;
+    AtomicMemory::Allocation stagingBufferMemory;
+    createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    memcpy(stagingBufferMemory.mapped, &texel, static_cast<size_t>(imageSize));
+
+    createImage(1, 1, 1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, placeholder.image, placeholder.memory);
+
+    transitionImageLayout(placeholder.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
+    copyBufferToImage(stagingBuffer, placeholder.image, 1, 1);
+    transitionImageLayout(placeholder.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
+
+    releaseAfterSetup(stagingBuffer, stagingBufferMemory);
+
+    placeholder.view = createImageView(placeholder.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+    placeholder.slot = bindless.add(placeholder.view);
+  }
+
+  initSwapChain();
+  initAssets();
+}
+
+// Swapchain lifetime: swapchain, image views, attachments, framebuffers, per-image descriptor sets and command buffers
+void AtomicVK::initSwapChain()
+{
+  VkFormat previous_format = swapchain_image_format;
+
+  // Init Swap Chain
   {
     SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physical_device);
 
@@ -427,7 +820,7 @@ void AtomicVK::initVulkan(bool recreate)
     swapchain_extent = extent;
   }
 
-  // Init Image Views {{{RECREATE}}}
+  // Init Image Views
   {
     swapChainImageViews.resize(swapchain_images.size());
 
@@ -436,302 +829,25 @@ void AtomicVK::initVulkan(bool recreate)
     }
   }
 
-  // Init Render Passes {{{RECREATE}}}
-  {
-    VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = swapchain_image_format;
-    colorAttachment.samples = msaaSamples;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentDescription depthAttachment{};
-    depthAttachment.format = findDepthFormat();
-    depthAttachment.samples = msaaSamples;
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentDescription colorAttachmentResolve{};
-    colorAttachmentResolve.format = swapchain_image_format;
-    colorAttachmentResolve.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachmentResolve.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachmentResolve.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentReference colorAttachmentRef{};
-    colorAttachmentRef.attachment = 0;
-    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentReference depthAttachmentRef{};
-    depthAttachmentRef.attachment = 1;
-    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentReference colorAttachmentResolveRef{};
-    colorAttachmentResolveRef.attachment = 2;
-    colorAttachmentResolveRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    VkSubpassDescription subpass{};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
-    subpass.pDepthStencilAttachment = &depthAttachmentRef;
-    subpass.pResolveAttachments = &colorAttachmentResolveRef;
-
-    VkSubpassDependency dependency{};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-    std::array<VkAttachmentDescription, 3> attachments = {colorAttachment, depthAttachment, colorAttachmentResolve };
-    VkRenderPassCreateInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-    renderPassInfo.pAttachments = attachments.data();
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
-
-    if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
-      throw std::runtime_error("failed to create render pass!");
-    }
-  }
-
-  // Init Descriptor Set Layout
-  if (!recreate)
-  {
-    VkDescriptorSetLayoutBinding uboLayoutBinding{};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.pImmutableSamplers = nullptr;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-    VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-    samplerLayoutBinding.binding = 1;
-    samplerLayoutBinding.descriptorCount = 1;
-    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.pImmutableSamplers = nullptr;
-    samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
-
-    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
-      throw std::runtime_error("failed to create descriptor set layout!");
-    }
-  }
-
-  // Init Graphics Pipeline {{{RECREATE}}}
+  // Surface format changed: the render pass and pipelines must follow
+  if (swapchain_image_format != previous_format)
   {
-    std::vector<char> vertShaderCode, fragShaderCode;
-    VkShaderModule vertShaderModule, fragShaderModule;
-    VkPipelineShaderStageCreateInfo shaderStages[2];
-
-    // Shader Modules
-    {
-      vertShaderCode = readFile("/Users/chester/Documents/Me/AtomicEngine/src/shaders/spirv/shader.vert.spv");
-      fragShaderCode = readFile("/Users/chester/Documents/Me/AtomicEngine/src/shaders/spirv/shader.frag.spv");
-
-      vertShaderModule = createShaderModule(vertShaderCode);
-      fragShaderModule = createShaderModule(fragShaderCode);
-
-      VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-      vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-      vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-      vertShaderStageInfo.module = vertShaderModule;
-      vertShaderStageInfo.pName = "main";
-
-      VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-      fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-      fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-      fragShaderStageInfo.module = fragShaderModule;
-      fragShaderStageInfo.pName = "main";
-
-      shaderStages[0] = vertShaderStageInfo;
-      shaderStages[1] = fragShaderStageInfo;
-    }
-
-    // Fixed functions
-    {
-      // Vertex Input
-      VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-      vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-
-      // Enable Vertex Input from Graphics Pipeline
-      auto bindingDescription = Vertex::getBindingDescription();
-      auto attributeDescriptions = Vertex::getAttributeDescriptions();
-      vertexInputInfo.vertexBindingDescriptionCount = 1;
-      vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-      vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-      vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-      // Input Assembly
-      VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-      inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-      inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-      inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-      // Viewport
-      VkViewport viewport{};
-      viewport.x = 0.0f;
-      viewport.y = 0.0f;
-      viewport.width = (float) swapchain_extent.width;
-      viewport.height = (float) swapchain_extent.height;
-      viewport.minDepth = 0.0f;
-      viewport.maxDepth = 1.0f;
-
-      // Scissor
-      VkRect2D scissor {};
-      scissor.offset = {0, 0};
-      scissor.extent = swapchain_extent;
-
-      // Viewport State: Scissor, Viewport
-      VkPipelineViewportStateCreateInfo viewportState{};
-      viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-      viewportState.viewportCount = 1;
-      viewportState.pViewports = &viewport;
-      viewportState.scissorCount = 1;
-      viewportState.pScissors = &scissor;
-
-      // Rasterizer
-      VkPipelineRasterizationStateCreateInfo rasterizer{};
-      rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-      rasterizer.depthClampEnable = VK_FALSE;
-      rasterizer.rasterizerDiscardEnable = VK_FALSE;
-      rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-      rasterizer.lineWidth = 1.0f;
-      rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-      rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-      rasterizer.depthBiasEnable = VK_FALSE;
-
-      // Multisampling
-      VkPipelineMultisampleStateCreateInfo multisampling{};
-      multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-      multisampling.sampleShadingEnable = VK_FALSE;
-      //multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-      multisampling.rasterizationSamples = msaaSamples;
-      //multisampling.minSampleShading = 1.0f; // Optional
-      //multisampling.pSampleMask = nullptr; // Optional
-      //multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
-      //multisampling.alphaToOneEnable = VK_FALSE; // Optional
-
-      // Depth Stencil
-      VkPipelineDepthStencilStateCreateInfo depthStencil{};
-      depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-      depthStencil.depthTestEnable = VK_TRUE;
-      depthStencil.depthWriteEnable = VK_TRUE;
-      depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-      depthStencil.depthBoundsTestEnable = VK_FALSE;
-      depthStencil.stencilTestEnable = VK_FALSE;
-      //depthStencil.front = {}; // Optional
-      //depthStencil.back = {}; // Optional
-
-      // Color Blend Attachment
-      VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-      colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-      colorBlendAttachment.blendEnable = VK_FALSE;
-
-      // Enable Alpha Blending
-      if (0)
-      {
-        colorBlendAttachment.blendEnable = VK_TRUE;
-        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-      }
-
-      // Color Blend Descriptor Set
-      VkPipelineColorBlendStateCreateInfo colorBlending{};
-      colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-      colorBlending.logicOpEnable = VK_FALSE;
-      colorBlending.logicOp = VK_LOGIC_OP_COPY;
-      colorBlending.attachmentCount = 1;
-      colorBlending.pAttachments = &colorBlendAttachment;
-      colorBlending.blendConstants[0] = 0.0f;
-      colorBlending.blendConstants[1] = 0.0f;
-      colorBlending.blendConstants[2] = 0.0f;
-      colorBlending.blendConstants[3] = 0.0f;
-
-      // Pipeline Layout
-      VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-      pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-      pipelineLayoutInfo.setLayoutCount = 1;
-      pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-      //pipelineLayoutInfo.pushConstantRangeCount = 0;
-
-      if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
-        throw std::runtime_error("failed to create pipeline layout!");
-
-      // Graphics Pipeline descriptor
-      VkGraphicsPipelineCreateInfo pipelineInfo{};
-      pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-      pipelineInfo.stageCount = 2;
-      pipelineInfo.pStages = shaderStages;
-      pipelineInfo.pVertexInputState = &vertexInputInfo;
-      pipelineInfo.pInputAssemblyState = &inputAssembly;
-      pipelineInfo.pViewportState = &viewportState;
-      pipelineInfo.pRasterizationState = &rasterizer;
-      pipelineInfo.pMultisampleState = &multisampling;
-      pipelineInfo.pDepthStencilState = &depthStencil;
-      pipelineInfo.pColorBlendState = &colorBlending;
-      pipelineInfo.layout = pipelineLayout;
-      pipelineInfo.renderPass = renderPass;
-      pipelineInfo.subpass = 0;
-      pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-
-      if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
-        throw std::runtime_error("failed to create graphics pipeline!");
-    }
+    vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyRenderPass(device, renderPass, nullptr);
 
-    // Destroy Shader Modules
-    {
-      vkDestroyShaderModule(device, fragShaderModule, nullptr);
-      vkDestroyShaderModule(device, vertShaderModule, nullptr);
-    }
+    createRenderPass();
+    createGraphicsPipeline();
   }
 
-  // Init Command Pool
-  if (!recreate)
-  {
-    VkQueueFamilyIndices queueFamilyIndices = VkFindQueueFamilies(physical_device);
-
-    VkCommandPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-
-    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
-      throw std::runtime_error("failed to create graphics command pool!");
-    }
-  }
-
-  // Init Color Resources {{{RECREATE}}}
+  // Init Color Resources
   {
     VkFormat colorFormat = swapchain_image_format;
     createImage(swapchain_extent.width, swapchain_extent.height, 1, msaaSamples, colorFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, colorImage, colorImageMemory);
     colorImageView = createImageView(colorImage, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
   }
 
-  // Init Depth Resources {{{RECREATE}}}
+  // Init Depth Resources
   {
     depthFormat = findDepthFormat();
 
@@ -740,7 +856,7 @@ void AtomicVK::initVulkan(bool recreate)
     depthImageView = createImageView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
   }
 
-  // Init Frame Buffers {{{RECREATE}}}
+  // Init Frame Buffers
   {
     swapChainFramebuffers.resize(swapChainImageViews.size());
 
@@ -766,344 +882,819 @@ void AtomicVK::initVulkan(bool recreate)
     }
   }
 
-  // Init Texture Images
-  {
-    int texWidth, texHeight, texChannels;
-    //stbi_uc* pixels = stbi_load("../textures/trump.jpg", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    stbi_uc* pixels = stbi_load(load_texture, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
-    mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
-
-    if (!pixels) {
-      throw std::runtime_error("failed to load texture image!");
-    }
+  // Init Descriptor Pool
+  {
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[0].descriptorCount = static_cast<uint32_t>(swapchain_images.size());
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(swapchain_images.size());
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[2].descriptorCount = static_cast<uint32_t>(swapchain_images.size());
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = static_cast<uint32_t>(swapchain_images.size());
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create descriptor pool!");
+    }
+  }
+
+  // Init Descriptor Sets
+  {
+    std::vector<VkDescriptorSetLayout> layouts(swapchain_images.size(), descriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(swapchain_images.size());
+    allocInfo.pSetLayouts = layouts.data();
+
+    descriptorSets.resize(swapchain_images.size());
+    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+      throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    for (uint32_t i = 0; i < swapchain_images.size(); i++)
+      updateDescriptorSet(i);
+  }
+
+  // Init Command Buffers
+  {
+    commandBuffers.resize(swapChainFramebuffers.size());
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = (uint32_t) commandBuffers.size();
+
+    if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+      throw std::runtime_error("failed to allocate command buffers!");
+    }
+
+    // The device is idle: nothing still reads replaced textures or their slots
+    destroyRetiredTextures();
+    bindless.collect(UINT64_MAX);
+
+    imagesInFlight.assign(swapchain_images.size(), VK_NULL_HANDLE);
+  }
+}
+
+// Asset lifetime: model buffers, streamed texture; reload() re-runs this on an idle device
+void AtomicVK::initAssets(bool reload)
+{
+  // Stream the texture: its tail first, finer levels as its on-screen size asks for them (see updateResidency)
+  if (streamedTexture == ~0u)
+    streamedTexture = addTexture(load_texture);
+
+  // TEMP: Load .obj Model
+  loadModel();
+
+  // Init Vertex Buffer: source vertices encoded into GPUVertex (VERTEX_LAYOUT) straight into staging
+  {
+    VkDeviceSize bufferSize = (VkDeviceSize) sizeof(GPUVertex) * mesh.vertex_count;
+
+    // Reloading: the device is idle, drop the previous model
+    if (reload) {
+      destroyBuffer(vertexBuffer, vertexBufferMemory);
+      destroyBuffer(indexBuffer, indexBufferMemory);
+    }
+
+    VkBuffer stagingBuffer;
+    AtomicMemory::Allocation stagingBufferMemory;
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    // Writer sources (glTF) encode themselves, with the bounds loadModel() took from the accessors
+    if (mesh.write_vertices)
+      mesh.copyVertices(stagingBufferMemory.mapped);
+    else
+    {
+      // Welded or mapped float vertices: local bounds for culling and the range quantized positions span
+      const Vertex *source = (const Vertex*) mesh.vertices;
+      for (uint32_t v = 0; v < mesh.vertex_count; v++)
+      {
+        meshMin = v ? glm::min(meshMin, source[v].pos) : source[v].pos;
+        meshMax = v ? glm::max(meshMax, source[v].pos) : source[v].pos;
+      }
+      meshQuantization = AtomicVertex::quantization<GPUVertex>(meshMin, meshMax);
+
+      GPUVertex *encoded = (GPUVertex*) stagingBufferMemory.mapped;
+      engine->jobs.parallelFor(mesh.vertex_count, VERTEX_ENCODE_GRAIN, [&](size_t begin, size_t end)
+      {
+        for (size_t v = begin; v < end; v++)
+          GPUVertex::encode(source[v].pos, source[v].normal, source[v].texCoord, meshQuantization, encoded[v]);
+      });
+    }
+
+    if (ATOMICENGINE_DEBUG)
+      printf("Vertex buffer: %u vertices, %u bytes each\n", mesh.vertex_count, GPUVertex::stride);
+
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+
+    copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+
+    releaseAfterSetup(stagingBuffer, stagingBufferMemory);
+  }
+
+  // Init Index Buffer
+  {
+    VkDeviceSize bufferSize = sizeof(uint32_t) * mesh.index_count;
+
+    VkBuffer stagingBuffer;
+    AtomicMemory::Allocation stagingBufferMemory;
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    mesh.copyIndices(stagingBufferMemory.mapped);
+
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+
+    copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+
+    releaseAfterSetup(stagingBuffer, stagingBufferMemory);
+
+    // Mesh data now lives on the GPU; the loaded model is the scene's only mesh for now
+    scene.clear();
+    scene.addMesh(mesh.vertex_count, mesh.index_count, meshMin, meshMax, meshQuantization);
+    mesh.release();
+
+    // Per-mesh dequantization for the vertex shader; nothing is in flight (first load, or reload on an idle device)
+    scene.packMeshes((AtomicScene::MeshData*) meshBufferMemory.mapped);
+  }
+
+  // Submit all setup transfers at once; staging memory is freed from callback() when the fence signals
+  flushSetup();
+}
+
+void AtomicVK::createRenderPass()
+{
+  VkAttachmentDescription colorAttachment{};
+  colorAttachment.format = swapchain_image_format;
+  colorAttachment.samples = msaaSamples;
+  colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+  colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+  VkAttachmentDescription depthAttachment{};
+  depthAttachment.format = findDepthFormat();
+  depthAttachment.samples = msaaSamples;
+  depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+  VkAttachmentDescription colorAttachmentResolve{};
+  colorAttachmentResolve.format = swapchain_image_format;
+  colorAttachmentResolve.samples = VK_SAMPLE_COUNT_1_BIT;
+  colorAttachmentResolve.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  colorAttachmentResolve.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+  colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+  VkAttachmentReference colorAttachmentRef{};
+  colorAttachmentRef.attachment = 0;
+  colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+  VkAttachmentReference depthAttachmentRef{};
+  depthAttachmentRef.attachment = 1;
+  depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+  VkAttachmentReference colorAttachmentResolveRef{};
+  colorAttachmentResolveRef.attachment = 2;
+  colorAttachmentResolveRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+  VkSubpassDescription subpass{};
+  subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+  subpass.colorAttachmentCount = 1;
+  subpass.pColorAttachments = &colorAttachmentRef;
+  subpass.pDepthStencilAttachment = &depthAttachmentRef;
+  subpass.pResolveAttachments = &colorAttachmentResolveRef;
+
+  VkSubpassDependency dependency{};
+  dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+  dependency.dstSubpass = 0;
+  dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  dependency.srcAccessMask = 0;
+  dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+  std::array<VkAttachmentDescription, 3> attachments = {colorAttachment, depthAttachment, colorAttachmentResolve };
+  VkRenderPassCreateInfo renderPassInfo{};
+  renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+  renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+  renderPassInfo.pAttachments = attachments.data();
+  renderPassInfo.subpassCount = 1;
+  renderPassInfo.pSubpasses = &subpass;
+  renderPassInfo.dependencyCount = 1;
+  renderPassInfo.pDependencies = &dependency;
+
+  if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+    throw std::runtime_error("failed to create render pass!");
+  }
+}
+
+void AtomicVK::createGraphicsPipeline()
+{
+  // Pipeline Layout
+  VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+  pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  // Set 0: per-frame uniforms and instances; set 1: bindless textures
+  std::array<VkDescriptorSetLayout, 2> setLayouts = {descriptorSetLayout, bindless.layout};
+  pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+  pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+  //pipelineLayoutInfo.pushConstantRangeCount = 0;
+
+  if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+    throw std::runtime_error("failed to create pipeline layout!");
+
+  graphicsPipeline = buildGraphicsPipeline();
+}
+
+// Shader stages + fixed functions; also the hot-reload entry point, so it must not touch pipelineLayout
+VkPipeline AtomicVK::buildGraphicsPipeline()
+{
+  VkPipeline pipeline;
+  VkShaderModule vertShaderModule, fragShaderModule;
+  VkPipelineShaderStageCreateInfo shaderStages[2];
+
+  // Shader Modules
+  {
+    vertShaderModule = shaders.load("shader.vert", GPUVertex::defines());
+    fragShaderModule = shaders.load("shader.frag");
+
+    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertShaderStageInfo.module = vertShaderModule;
+    vertShaderStageInfo.pName = "main";
+
+    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
+    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragShaderStageInfo.module = fragShaderModule;
+    fragShaderStageInfo.pName = "main";
+
+    shaderStages[0] = vertShaderStageInfo;
+    shaderStages[1] = fragShaderStageInfo;
+  }
+
+  // Fixed functions
+  {
+    // Vertex Input
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    // Enable Vertex Input from Graphics Pipeline: descriptions generated from the layout at compile time
+    static constexpr VkVertexInputBindingDescription bindingDescription = GPUVertex::binding();
+    static constexpr auto attributeDescriptions = GPUVertex::attributes();
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    // Input Assembly
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    // Viewport State: Scissor, Viewport (dynamic, set per command buffer so resizes keep the pipeline)
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    //multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.rasterizationSamples = msaaSamples;
+    //multisampling.minSampleShading = 1.0f; // Optional
+    //multisampling.pSampleMask = nullptr; // Optional
+    //multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
+    //multisampling.alphaToOneEnable = VK_FALSE; // Optional
+
+    // Depth Stencil
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+    //depthStencil.front = {}; // Optional
+    //depthStencil.back = {}; // Optional
+
+    // Color Blend Attachment
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_FALSE;
+
+    // Enable Alpha Blending
+    if (0)
+    {
+      colorBlendAttachment.blendEnable = VK_TRUE;
+      colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+      colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+      colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+      colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+      colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+      colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    }
+
+    // Color Blend Descriptor Set
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+    colorBlending.blendConstants[0] = 0.0f;
+    colorBlending.blendConstants[1] = 0.0f;
+    colorBlending.blendConstants[2] = 0.0f;
+    colorBlending.blendConstants[3] = 0.0f;
+
+    // Graphics Pipeline descriptor
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = renderPass;
+    pipelineInfo.subpass = 0;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    auto compile_start = std::chrono::steady_clock::now();
+
+    VkResult result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+
+    vkDestroyShaderModule(device, fragShaderModule, nullptr);
+    vkDestroyShaderModule(device, vertShaderModule, nullptr);
+
+    if (result != VK_SUCCESS)
+      throw std::runtime_error("failed to create graphics pipeline!");
+
+    double compile_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compile_start).count();
+    if (ATOMICENGINE_DEBUG)
+      printf("Graphics pipeline: %.3f ms (pipeline cache %s)\n", compile_ms, pipelineCacheWarm ? "warm" : "cold");
+  }
+
+  return pipeline;
+}
+
+// Rebuild only the pipelines whose shaders changed on disk; a broken shader keeps the old pipeline
+void AtomicVK::reloadShaders()
+{
+  std::vector<std::string> changed = shaders.changed();
+  if (changed.empty()) return;
+
+  for (auto &source : pipelineSources)
+  {
+    if (std::none_of(source.shaders.begin(), source.shaders.end(), [&](const std::string &name)
+        { return std::find(changed.begin(), changed.end(), name) != changed.end(); }))
+      continue;
+
+    auto start = std::chrono::steady_clock::now();
+    VkPipeline pipeline;
+
+    try { pipeline = (this->*source.build)(); }
+    catch (const std::exception &e)
+    {
+      printf("Shader reload failed: %s\n", e.what());
+      continue;
+    }
+
+    // Command buffers are re-recorded every frame, so only submitted frames still reference the old pipeline
+    vkQueueWaitIdle(graphics_queue);
+    vkDestroyPipeline(device, *source.pipeline, nullptr);
+    *source.pipeline = pipeline;
+
+    if (ATOMICENGINE_DEBUG)
+      printf("Reloaded pipeline (%s): %.2f ms\n", source.shaders[0].c_str(), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+}
+
+// Seed the pipeline cache from disk when the blob was written by this driver/device
+void AtomicVK::loadPipelineCache()
+{
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+  std::vector<char> data;
+  std::ifstream file(AtomicShader::executableDir() + "/" + PIPELINE_CACHE_FILE, std::ios::ate | std::ios::binary);
+  if (file.is_open())
+  {
+    data.resize((size_t) file.tellg());
+    file.seekg(0);
+    file.read(data.data(), data.size());
+  }
+
+  // Header: length, version, vendorID, deviceID, pipelineCacheUUID (VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+  struct Header { uint32_t length, version, vendor, device; uint8_t uuid[VK_UUID_SIZE]; } header{};
+  if (data.size() >= sizeof(Header)) memcpy(&header, data.data(), sizeof(Header));
+
+  pipelineCacheWarm = data.size() >= sizeof(Header)
+                      && header.length >= sizeof(Header)
+                      && header.version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                      && header.vendor == properties.vendorID
+                      && header.device == properties.deviceID
+                      && memcmp(header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+  if (!pipelineCacheWarm) data.clear();
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+  VkPipelineCacheCreateInfo cacheInfo{};
+  cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  cacheInfo.initialDataSize = data.size();
+  cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
 
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vkUnmapMemory(device, stagingBufferMemory);
+  if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS)
+    throw std::runtime_error("failed to create pipeline cache!");
 
-    stbi_image_free(pixels);
+  if (ATOMICENGINE_DEBUG)
+    printf("Pipeline cache: %s (%zu bytes)\n", pipelineCacheWarm ? "warm" : "cold", data.size());
+}
 
-    createImage(texWidth, texHeight, mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+void AtomicVK::savePipelineCache()
+{
+  size_t size = 0;
+  if (vkGetPipelineCacheData(device, pipelineCache, &size, nullptr) != VK_SUCCESS || !size) return;
 
-    transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
-    copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+  std::vector<char> data(size);
+  if (vkGetPipelineCacheData(device, pipelineCache, &size, data.data()) != VK_SUCCESS) return;
 
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+  if (!atomicengine_write_file(AtomicShader::executableDir() + "/" + PIPELINE_CACHE_FILE, data.data(), size) && ATOMICENGINE_DEBUG)
+    printf("Pipeline cache write failed\n");
+}
 
-    generateMipmaps(textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels);
-  }
+void AtomicVK::recordCommandBuffer(uint32_t i, const AtomicFrame &frame)
+{
+  uint32_t dynamicOffsets[2] = {0, static_cast<uint32_t>(sizeof(AtomicScene::InstanceData) * SCENE_MAX_INSTANCES * currentFrame)};
 
-  // Init Texture Image View
-  {
-    textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
-  }
+  // Cull: world bounds of every instance, tested against the frustum of proj * view
+  size_t instance_count = std::min<size_t>(frame.instances.size(), SCENE_MAX_INSTANCES);
+  cull.resize(instance_count);
 
-  // Init Texture Sampler
+  engine->jobs.parallelFor(instance_count, CULL_GRAIN, [&](size_t begin, size_t end)
   {
-    VkSamplerCreateInfo samplerInfo{};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_FALSE;
-    samplerInfo.maxAnisotropy = 16.0f;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    //samplerInfo.minLod = 0.0f;
-    samplerInfo.minLod = static_cast<float>(mipLevels * test_mip);
-    samplerInfo.maxLod = static_cast<float>(mipLevels);
-    samplerInfo.mipLodBias = 0.0f;
-
-    if (vkCreateSampler(device, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS) {
-      throw std::runtime_error("failed to create texture sampler!");
+    for (size_t n = begin; n < end; n++)
+    {
+      const AtomicScene::Instance &instance = frame.instances[n];
+      if (const AtomicScene::Mesh *mesh = scene.mesh(instance.mesh)) cull.setTransformed(n, instance.model, mesh->min, mesh->max);
+      else cull.set(n, glm::vec3(0.0f), glm::vec3(0.0f));
     }
-  }
-
-  // TEMP: Load .obj Model
-  if (!recreate || _load_model)
-  {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
+  });
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, load_model)) {
-      throw std::runtime_error(warn + err);
-    }
+  size_t visible = cull.cullParallel(engine->jobs, AtomicCull::frustum(projection(frame) * frame.view), visibleInstances.data());
+  visible_instances = (uint32_t) visible;
 
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-
-    for (const auto& shape : shapes) {
-      for (const auto& index : shape.mesh.indices) {
-        Vertex vertex{};
-
-        if (_load_model)
-          vertex.pos = {
-            attrib.vertices[3 * index.vertex_index + 0],
-            attrib.vertices[3 * index.vertex_index + 1],
-            attrib.vertices[3 * index.vertex_index + 2]
-          };
-        else
-          vertex.pos = {0, 0, 0};
-
-        if (_load_model && (int) sizeof(attrib.texcoords) <= (int) 2 * index.texcoord_index + 1)
-          vertex.texCoord = {
-                  attrib.texcoords[2 * index.texcoord_index + 0],
-                  1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-          };
-        else
-          vertex.texCoord = {0, 0};
-
-        vertex.color = {1.0f, 0.0f, 0.0f};
-
-        if (uniqueVertices.count(vertex) == 0) {
-          uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-          vertices.push_back(vertex);
-        }
+  // Texture residency follows what is on screen
+  updateResidency(frame, visible);
+  dynamicOffsets[0] = updateUniformBuffer(frame);
 
-        indices.push_back(uniqueVertices[vertex]);
-      }
-    }
+  // Each texture's bindless slot, sampler and min LOD, resolved into the instance records below
+  materials.resize(textures.size());
+  for (uint32_t id = 0; id < textures.size(); id++)
+  {
+    const BoundTexture &bound = textures[id];
+    materials[id].texture = bound.slot;
+    materials[id].sampler = bound.sampler;
+    materials[id].min_lod = std::max(residency.minLod(id), test_mip * bound.mipLevels);
   }
 
-  // Init Vertex Buffer
-  if (!recreate || _load_model)
-  {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
+  // Survivors bucketed by mesh into this frame's instance and indirect regions
+  AtomicScene::InstanceData *records = (AtomicScene::InstanceData*) ((uint8_t*) instanceRingMemory.mapped + dynamicOffsets[1]);
+  uint32_t draws = scene.build(frame.instances.data(), visibleInstances.data(), visible, materials.data(), materials.size(), records, indirectCommands.data(), SCENE_MAX_MESHES);
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+  memcpy((VkDrawIndexedIndirectCommand*) indirectRingMemory.mapped + SCENE_MAX_MESHES * currentFrame, indirectCommands.data(), sizeof(VkDrawIndexedIndirectCommand) * draws);
 
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertices.data(), (size_t) bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
+  // Split the indirect draws into batches, each recorded into its own secondary command buffer on the job system
+  uint32_t batches = std::clamp<uint32_t>((draws + SECONDARY_BATCH_MIN_DRAWS - 1) / SECONDARY_BATCH_MIN_DRAWS, 1, secondaryBatches);
+  size_t per_batch = (draws + batches - 1) / batches;
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+  // A failed batch rethrows here once every batch has finished
+  secondaryCmds.resize(batches);
+  engine->jobs.parallelFor(batches, 1, [&](size_t begin, size_t end)
+  {
+    for (size_t b = begin; b < end; b++)
+    {
+      SecondaryPool &secondary = secondaryPools[currentFrame * secondaryBatches + b];
+      recordSecondary(i, std::min<size_t>(draws, b * per_batch), std::min<size_t>(draws, (b + 1) * per_batch), dynamicOffsets, secondary);
+      secondaryCmds[b] = secondary.cmd;
+    }
+  });
 
-    copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+  // Primary: the render pass around the batches
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+  if (vkBeginCommandBuffer(commandBuffers[i], &beginInfo) != VK_SUCCESS) {
+    throw std::runtime_error("failed to begin recording command buffer!");
   }
 
-  // Init Index Buffer
-  if (!recreate || _load_model)
-  {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+  VkRenderPassBeginInfo renderPassInfo{};
+  renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  renderPassInfo.renderPass = renderPass;
+  renderPassInfo.framebuffer = swapChainFramebuffers[i];
+  renderPassInfo.renderArea.offset = {0, 0};
+  renderPassInfo.renderArea.extent = swapchain_extent;
 
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices.data(), (size_t) bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
+  std::array<VkClearValue, 2> clearValues{};
+  clearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
+  clearValues[1].depthStencil = {1.0f, 0};
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+  renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+  renderPassInfo.pClearValues = clearValues.data();
 
-    copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+  vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+  vkCmdExecuteCommands(commandBuffers[i], batches, secondaryCmds.data());
+  vkCmdEndRenderPass(commandBuffers[i]);
 
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+  if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS) {
+    throw std::runtime_error("failed to record command buffer!");
   }
+}
 
-  // Init Uniform Buffers {{{RECREATE}}}
-  {
-    VkDeviceSize bufferSize = sizeof(UniformBufferObject) + sizeof(UniformBufferCamera);
+// Record indirect draws [begin, end) of this frame into a secondary command buffer; runs on a job worker
+void AtomicVK::recordSecondary(uint32_t i, size_t begin, size_t end, const uint32_t *dynamicOffsets, SecondaryPool &secondary)
+{
+  // This frame's fence was waited on, so the pool's previous recording has retired
+  vkResetCommandPool(device, secondary.pool, 0);
+
+  VkCommandBufferInheritanceInfo inheritance{};
+  inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritance.renderPass = renderPass;
+  inheritance.subpass = 0;
+  inheritance.framebuffer = swapChainFramebuffers[i];
 
-    uniformBuffers.resize(swapchain_images.size());
-    uniformBuffersMemory.resize(swapchain_images.size());
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  beginInfo.pInheritanceInfo = &inheritance;
 
-    for (size_t i=0; i<swapchain_images.size(); i++)
-      createBuffer(bufferSize,
-                   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                   uniformBuffers[i],
-                   uniformBuffersMemory[i]);
+  VkCommandBuffer cmd = secondary.cmd;
+  if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
+    throw std::runtime_error("failed to begin recording secondary command buffer!");
   }
 
-  // Init Descriptor Pool {{{RECREATE}}}
-  {
-    std::array<VkDescriptorPoolSize, 2> poolSizes{};
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[0].descriptorCount = static_cast<uint32_t>(swapchain_images.size());
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = static_cast<uint32_t>(swapchain_images.size());
+  // Secondaries inherit nothing but the render pass: pipeline, dynamic state and buffers are bound per batch
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
 
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = static_cast<uint32_t>(swapchain_images.size());
+  VkViewport viewport{};
+  viewport.width = (float) swapchain_extent.width;
+  viewport.height = (float) swapchain_extent.height;
+  viewport.minDepth = 0.0f;
+  viewport.maxDepth = 1.0f;
+  vkCmdSetViewport(cmd, 0, 1, &viewport);
 
-    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-      throw std::runtime_error("failed to create descriptor pool!");
-    }
-  }
+  VkRect2D scissor{};
+  scissor.extent = swapchain_extent;
+  vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-  // Init Descriptor Sets {{{RECREATE}}}
-  {
-    std::vector<VkDescriptorSetLayout> layouts(swapchain_images.size(), descriptorSetLayout);
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(swapchain_images.size());
-    allocInfo.pSetLayouts = layouts.data();
+  VkBuffer vertexBuffers[] = {vertexBuffer};
+  VkDeviceSize offsets[] = {0};
+  vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
 
-    descriptorSets.resize(swapchain_images.size());
-    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
-      throw std::runtime_error("failed to allocate descriptor sets!");
-    }
+  //vkCmdBindIndexBuffer(cmd, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+  vkCmdBindIndexBuffer(cmd, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-    for (size_t i = 0; i < swapchain_images.size(); i++) {
-      VkDescriptorBufferInfo bufferInfo{};
-      bufferInfo.buffer = uniformBuffers[i];
-      bufferInfo.offset = 0;
-      bufferInfo.range = sizeof(UniformBufferObject) + sizeof(UniformBufferCamera);
-
-      VkDescriptorImageInfo imageInfo{};
-      imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      imageInfo.imageView = textureImageView;
-      imageInfo.sampler = textureSampler;
-
-      std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
-
-      descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      descriptorWrites[0].dstSet = descriptorSets[i];
-      descriptorWrites[0].dstBinding = 0;
-      descriptorWrites[0].dstArrayElement = 0;
-      descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-      descriptorWrites[0].descriptorCount = 1;
-      descriptorWrites[0].pBufferInfo = &bufferInfo;
-
-      descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      descriptorWrites[1].dstSet = descriptorSets[i];
-      descriptorWrites[1].dstBinding = 1;
-      descriptorWrites[1].dstArrayElement = 0;
-      descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-      descriptorWrites[1].descriptorCount = 1;
-      descriptorWrites[1].pImageInfo = &imageInfo;
-
-      vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
-    }
-  }
+  // Uniforms and instances: this frame's slices, selected by dynamic offset (binding order); then every texture
+  VkDescriptorSet sets[] = {descriptorSets[i], bindless.set};
+  vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 2, sets, 2, dynamicOffsets);
+
+  const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+  VkDeviceSize first = (VkDeviceSize) stride * (SCENE_MAX_MESHES * currentFrame + begin);
 
-  // Init Command Buffers {{{RECREATE}}}
+  // firstInstance != 0 in an indirect command needs drawIndirectFirstInstance; without it, issue the same commands directly
+  if (!indirectFirstInstance)
   {
-    commandBuffers.resize(swapChainFramebuffers.size());
+    for (size_t d = begin; d < end; d++)
+    {
+      const VkDrawIndexedIndirectCommand &command = indirectCommands[d];
+      vkCmdDrawIndexed(cmd, command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+    }
+  }
+  else if (multiDrawIndirect)
+    vkCmdDrawIndexedIndirect(cmd, indirectRing, first, (uint32_t) (end - begin), stride);
+  else
+    for (size_t d = begin; d < end; d++)
+      vkCmdDrawIndexedIndirect(cmd, indirectRing, first + (d - begin) * stride, 1, stride);
+
+  if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+    throw std::runtime_error("failed to record secondary command buffer!");
+  }
+}
 
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = (uint32_t) commandBuffers.size();
+void AtomicVK::updateDescriptorSet(uint32_t i)
+{
+  VkDescriptorBufferInfo bufferInfo{};
+  bufferInfo.buffer = uniformRing;
+  bufferInfo.offset = 0;
+  bufferInfo.range = sizeof(UniformBufferObject) + sizeof(UniformBufferCamera);
+
+  // One frame's region of the instance ring; the dynamic offset picks the frame
+  VkDescriptorBufferInfo instanceInfo{};
+  instanceInfo.buffer = instanceRing;
+  instanceInfo.offset = 0;
+  instanceInfo.range = sizeof(AtomicScene::InstanceData) * SCENE_MAX_INSTANCES;
+
+  VkDescriptorBufferInfo meshInfo{};
+  meshInfo.buffer = meshBuffer;
+  meshInfo.offset = 0;
+  meshInfo.range = sizeof(AtomicScene::MeshData) * SCENE_MAX_MESHES;
+
+  std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+
+  descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  descriptorWrites[0].dstSet = descriptorSets[i];
+  descriptorWrites[0].dstBinding = 0;
+  descriptorWrites[0].dstArrayElement = 0;
+  descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+  descriptorWrites[0].descriptorCount = 1;
+  descriptorWrites[0].pBufferInfo = &bufferInfo;
+
+  descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  descriptorWrites[1].dstSet = descriptorSets[i];
+  descriptorWrites[1].dstBinding = 2;
+  descriptorWrites[1].dstArrayElement = 0;
+  descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+  descriptorWrites[1].descriptorCount = 1;
+  descriptorWrites[1].pBufferInfo = &instanceInfo;
+
+  descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  descriptorWrites[2].dstSet = descriptorSets[i];
+  descriptorWrites[2].dstBinding = 3;
+  descriptorWrites[2].dstArrayElement = 0;
+  descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  descriptorWrites[2].descriptorCount = 1;
+  descriptorWrites[2].pBufferInfo = &meshInfo;
+
+  vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
 
-    if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
-      throw std::runtime_error("failed to allocate command buffers!");
-    }
+// A streamed texture: residency picks its levels, the placeholder's slot stands in until the first load lands
+uint32_t AtomicVK::addTexture(const std::string &path)
+{
+  uint32_t id = residency.add(path);
 
-    for (size_t i = 0; i < commandBuffers.size(); i++) {
-      VkCommandBufferBeginInfo beginInfo{};
-      beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  BoundTexture bound;
+  bound.slot = placeholder.slot;
+  textures.push_back(bound);
 
-      if (vkBeginCommandBuffer(commandBuffers[i], &beginInfo) != VK_SUCCESS) {
-        throw std::runtime_error("failed to begin recording command buffer!");
-      }
+  return id;
+}
 
-      VkRenderPassBeginInfo renderPassInfo{};
-      renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-      renderPassInfo.renderPass = renderPass;
-      renderPassInfo.framebuffer = swapChainFramebuffers[i];
-      renderPassInfo.renderArea.offset = {0, 0};
-      renderPassInfo.renderArea.extent = swapchain_extent;
+void AtomicVK::onTextureUploaded(uint32_t id, const AtomicUpload::Texture &texture)
+{
+  // A fresh slot: the current one may still be read by frames in flight
+  uint32_t slot = bindless.add(texture.view);
+  if (slot == ~0u)
+  {
+    // Array full: keep what is bound, residency asks again on a later frame
+    if (ATOMICENGINE_DEBUG) printf("Bindless array full (%u slots): dropped %s\n", bindless.capacity, residency.texture(id).path.c_str());
 
-      std::array<VkClearValue, 2> clearValues{};
-      clearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
-      clearValues[1].depthStencil = {1.0f, 0};
+    AtomicMemory::Allocation memory = texture.memory;
+    vkDestroyImageView(device, texture.view, nullptr);
+    destroyImage(texture.image, memory);
+    residency.cancel(id);
+    return;
+  }
 
-      renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-      renderPassInfo.pClearValues = clearValues.data();
+  residency.resident(id, texture.baseLevel, texture.chainWidth, texture.chainHeight, texture.chainLevels, texture.memory.size);
 
-      vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+  BoundTexture &bound = textures[id];
+  if (bound.image != VK_NULL_HANDLE)
+  {
+    retiredTextures.push_back({bound.image, bound.memory, bound.view, frameNumber});
+    bindless.release(bound.slot, frameNumber);
+  }
 
-      vkCmdBindPipeline(commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+  bound.image = texture.image;
+  bound.memory = texture.memory;
+  bound.view = texture.view;
+  bound.mipLevels = texture.mipLevels;
+  bound.slot = slot;
+}
 
-      VkBuffer vertexBuffers[] = {vertexBuffer};
-      VkDeviceSize offsets[] = {0};
-      vkCmdBindVertexBuffers(commandBuffers[i], 0, 1, vertexBuffers, offsets);
+// Render thread, after culling: on-screen size of each visible instance feeds its texture's residency
+void AtomicVK::updateResidency(const AtomicFrame &frame, size_t visible)
+{
+  // Pixels covered by one unit at unit view depth
+  float pixels_per_unit = swapchain_extent.height / (2.0f * std::tan(glm::radians(frame.fov) * 0.5f));
 
-      //vkCmdBindIndexBuffer(commandBuffers[i], indexBuffer, 0, VK_INDEX_TYPE_UINT16);
-      vkCmdBindIndexBuffer(commandBuffers[i], indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+  for (size_t k = 0; k < visible; k++)
+  {
+    uint32_t n = visibleInstances[k];
+    glm::vec3 center = cull.center(n);
 
-      vkCmdBindDescriptorSets(commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[i], 0, nullptr);
+    // Bounding sphere of the world box, at its view depth
+    float depth = -(frame.view[0][2] * center.x + frame.view[1][2] * center.y + frame.view[2][2] * center.z + frame.view[3][2]);
+    residency.observe(frame.instances[n].texture, 2.0f * glm::length(cull.extent(n)) * pixels_per_unit / std::max(depth, frame.z_near));
+  }
 
-      vkCmdDrawIndexed(commandBuffers[i], static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+  uint64_t now = AtomicTimer::nowNS();
+  double dt = residencyTime ? (now - residencyTime) / 1e9 : 0.0;
+  residencyTime = now;
 
-      vkCmdEndRenderPass(commandBuffers[i]);
+  residencyRequests.clear();
+  residency.update(dt, residencyRequests);
 
-      if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
-      }
-    }
+  for (const AtomicResidency::Request &request : residencyRequests)
+  {
+    uint32_t id = request.texture;
+    upload.loadTexture(residency.texture(id).path, [this, id](const AtomicUpload::Texture &texture) { onTextureUploaded(id, texture); }, request.max_extent);
   }
+}
 
-  // Create Semaphores
-  if (!recreate)
+// Images replaced before `frame`: every frame that could sample them has completed
+void AtomicVK::destroyRetiredTextures(uint64_t frame)
+{
+  for (size_t n = 0; n < retiredTextures.size();)
   {
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-    imagesInFlight.resize(swapchain_images.size(), VK_NULL_HANDLE);
-
-    VkSemaphoreCreateInfo semaphoreInfo{};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    RetiredTexture &t = retiredTextures[n];
+    if (t.frame > frame) { n++; continue; }
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    vkDestroyImageView(device, t.view, nullptr);
+    destroyImage(t.image, t.memory);
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-      if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-          vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-          vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
-        throw std::runtime_error("failed to create synchronization objects for a frame!");
-    }
+    t = retiredTextures.back();
+    retiredTextures.pop_back();
   }
 }
 
 void AtomicVK::destroyVulkan()
 {
+  vkDeviceWaitIdle(device);
   cleanSwapChain();
 
-  vkDestroySampler(device, textureSampler, nullptr);
-  vkDestroyImageView(device, textureImageView, nullptr);
+  upload.destroy();
 
-  vkDestroyImage(device, textureImage, nullptr);
-  vkFreeMemory(device, textureImageMemory, nullptr);
+  collectSetup(true);
+  for (auto fence : setupFreeFences) vkDestroyFence(device, fence, nullptr);
+  setupFreeFences.clear();
+  setupFreeCmds.clear();
 
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+  destroyRetiredTextures();
+
+  for (auto &bound : textures)
+  {
+    if (bound.image == VK_NULL_HANDLE) continue;
+    vkDestroyImageView(device, bound.view, nullptr);
+    destroyImage(bound.image, bound.memory);
+  }
+  textures.clear();
 
-  vkDestroyBuffer(device, indexBuffer, nullptr);
-  vkFreeMemory(device, indexBufferMemory, nullptr);
+  vkDestroyImageView(device, placeholder.view, nullptr);
+  destroyImage(placeholder.image, placeholder.memory);
 
-  vkDestroyBuffer(device, vertexBuffer, nullptr);
-  vkFreeMemory(device, vertexBufferMemory, nullptr);
+  vkDestroyPipeline(device, graphicsPipeline, nullptr);
+  vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+  vkDestroyRenderPass(device, renderPass, nullptr);
+
+  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+  bindless.destroy();
+
+  destroyBuffer(indexBuffer, indexBufferMemory);
+  destroyBuffer(vertexBuffer, vertexBufferMemory);
+  destroyBuffer(uniformRing, uniformRingMemory);
+  destroyBuffer(instanceRing, instanceRingMemory);
+  destroyBuffer(indirectRing, indirectRingMemory);
+  destroyBuffer(meshBuffer, meshBufferMemory);
 
   for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
     vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
@@ -1111,8 +1702,19 @@ void AtomicVK::destroyVulkan()
     vkDestroyFence(device, inFlightFences[i], nullptr);
   }
 
+  for (auto &secondary : secondaryPools) vkDestroyCommandPool(device, secondary.pool, nullptr);
+  secondaryPools.clear();
+
+  vkDestroyCommandPool(device, setupPool, nullptr);
   vkDestroyCommandPool(device, commandPool, nullptr);
 
+  if (ATOMICENGINE_DEBUG) allocator.printStats();
+  allocator.destroy();
+  shaders.destroy();
+
+  savePipelineCache();
+  vkDestroyPipelineCache(device, pipelineCache, nullptr);
+
   vkDestroyDevice(device, nullptr);
 
   if (validation_layers_enabled) {
@@ -1134,6 +1736,23 @@ void AtomicVK::initScreen()
   glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
   glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
   window = glfwCreateWindow(w_width, w_height, "AtomicEngine 0.1", nullptr, nullptr);
+
+  // Framebuffer size is main-thread state; the render thread reads the cached copy
+  int width, height;
+  glfwGetFramebufferSize(window, &width, &height);
+  framebuffer_width = width;
+  framebuffer_height = height;
+
+  glfwSetWindowUserPointer(window, this);
+  glfwSetFramebufferSizeCallback(window, AtomicVK::framebufferResizeCallback);
+}
+
+void AtomicVK::framebufferResizeCallback(GLFWwindow* window, int width, int height)
+{
+  AtomicVK *gpu = (AtomicVK*) glfwGetWindowUserPointer(window);
+  gpu->framebuffer_width = width;
+  gpu->framebuffer_height = height;
+  gpu->framebufferResized = true;
 }
 
 void AtomicVK::destroyScreen()
@@ -1170,7 +1789,7 @@ bool AtomicVK::VkDeviceValidate(VkPhysicalDevice device)
     swapchain_adequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
   }
 
-  return indices.completed() && extensions_supported && swapchain_adequate;
+  return indices.completed() && extensions_supported && swapchain_adequate && AtomicBindless::supported(device);
 }
 
 // Validation layer callback
@@ -1200,13 +1819,19 @@ AtomicVK::VkQueueFamilyIndices AtomicVK::VkFindQueueFamilies(VkPhysicalDevice de
   int i = 0;
   for (const auto& queue_family : queue_families)
   {
-    if (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) indices.graphicsFamily = i;
+    if (!indices.completed())
+    {
+      if (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) indices.graphicsFamily = i;
 
-    VkBool32 present_support = false;
-    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
+      VkBool32 present_support = false;
+      vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
 
-    if (present_support) indices.presentFamily = i;
-    if (indices.completed()) break;
+      if (present_support) indices.presentFamily = i;
+    }
+
+    // Transfer-only family (DMA engine) for asynchronous uploads
+    if (!indices.transferFamily.has_value() && (queue_family.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+      indices.transferFamily = i;
 
     i++;
   }
@@ -1229,7 +1854,7 @@ bool AtomicVK::checkDeviceExtensionSupport(VkPhysicalDevice device)
   return requiredExtensions.empty();
 }
 
-void AtomicVK::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+void AtomicVK::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, AtomicMemory::Allocation& bufferMemory)
 {
   VkBufferCreateInfo bufferInfo{};
   bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -1244,82 +1869,65 @@ void AtomicVK::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemor
   VkMemoryRequirements memRequirements;
   vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+  bufferMemory = allocator.allocate(memRequirements, findMemoryType(memRequirements.memoryTypeBits, properties), true);
 
-  if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate buffer memory!");
-  }
+  vkBindBufferMemory(device, buffer, bufferMemory.memory, bufferMemory.offset);
+}
 
-  vkBindBufferMemory(device, buffer, bufferMemory, 0);
+void AtomicVK::destroyBuffer(VkBuffer buffer, AtomicMemory::Allocation& bufferMemory)
+{
+  vkDestroyBuffer(device, buffer, nullptr);
+  allocator.free(bufferMemory);
 }
 
 void AtomicVK::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
 {
-  VkCommandBufferAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandPool = commandPool;
-  allocInfo.commandBufferCount = 1;
-
-  VkCommandBuffer commandBuffer;
-  vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-  VkCommandBufferBeginInfo beginInfo{};
-  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-  vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
   VkBufferCopy copyRegion{};
   copyRegion.size = size;
-  vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-  vkEndCommandBuffer(commandBuffer);
-
-  VkSubmitInfo submitInfo{};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer;
-
-  vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(graphics_queue);
-
-  vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+  vkCmdCopyBuffer(setupCommands(), srcBuffer, dstBuffer, 1, &copyRegion);
 }
 
-void AtomicVK::updateUniformBuffer(uint32_t currentImage)
+uint32_t AtomicVK::updateUniformBuffer(const AtomicFrame &frame)
 {
-  static auto startTime = std::chrono::high_resolution_clock::now();
-  auto currentTime = std::chrono::high_resolution_clock::now();
-  float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-
-  // UBO
+  // UBO: per frame; per-instance transforms live in the instance ring
   UniformBufferObject ubo{};
-  ubo.model = glm::scale(glm::mat4(test_scale), glm::vec3(test_scale));
-  ubo.model *= glm::rotate(glm::mat4(1.2f), time * glm::radians(-10.0f), glm::vec3(0.5f, 0.5f, 1.0f));
-  ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-  ubo.proj = glm::perspective(glm::radians(45.0f), swapchain_extent.width / (float) swapchain_extent.height, 0.1f, 10.0f);
-  ubo.proj[1][1] *= -1;
+  ubo.view = frame.view;
+  ubo.proj = projection(frame);
 
-  void *data;
-  vkMapMemory(device, uniformBuffersMemory[currentImage], 0, sizeof(ubo), 0, &data);
-  memcpy(data, &ubo, sizeof(ubo));
-  vkUnmapMemory(device, uniformBuffersMemory[currentImage]);
+  VkDeviceSize offset = uniformAlloc(sizeof(UniformBufferObject) + sizeof(UniformBufferCamera));
+  uint8_t *slice = (uint8_t*) uniformRingMemory.mapped + offset;
+
+  memcpy(slice, &ubo, sizeof(ubo));
 
   // Camera
   UniformBufferCamera camera{};
-  camera.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+  camera.view = frame.camera_view;
+
+  memcpy(slice + sizeof(ubo), &camera, sizeof(camera));
+
+  return static_cast<uint32_t>(offset);
+}
 
-  void *data2;
-  vkMapMemory(device, uniformBuffersMemory[currentImage], 0, sizeof(camera), 0, &data2);
-  memcpy(data2, &camera, sizeof(camera));
-  vkUnmapMemory(device, uniformBuffersMemory[currentImage]);
+glm::mat4 AtomicVK::projection(const AtomicFrame &frame) const
+{
+  glm::mat4 proj = glm::perspective(glm::radians(frame.fov), swapchain_extent.width / (float) swapchain_extent.height, frame.z_near, frame.z_far);
+  proj[1][1] *= -1;
+  return proj;
+}
+
+// Carve an aligned slice out of the current frame's uniform region
+VkDeviceSize AtomicVK::uniformAlloc(VkDeviceSize size)
+{
+  // Slices are rounded up to the alignment, so a single atomic bump keeps every offset aligned across recording threads
+  VkDeviceSize aligned = (size + uniformAlignment - 1) & ~(uniformAlignment - 1);
+  VkDeviceSize offset = uniformCursor.fetch_add(aligned, std::memory_order_relaxed);
+  if (offset + size > UNIFORM_RING_FRAME_SIZE)
+    throw std::runtime_error("uniform ring frame region exhausted!");
+
+  return currentFrame * UNIFORM_RING_FRAME_SIZE + offset;
 }
 
-void AtomicVK::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+void AtomicVK::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, AtomicMemory::Allocation& imageMemory, const std::vector<uint32_t>& queueFamilies)
 {
   VkImageCreateInfo imageInfo{};
   imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -1336,6 +1944,13 @@ void AtomicVK::createImage(uint32_t width, uint32_t height, uint32_t mipLevels,
   imageInfo.samples = numSamples;
   imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+  // Shared between queue families (e.g. transfer + graphics) without ownership transfers
+  if (queueFamilies.size() > 1) {
+    imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+    imageInfo.pQueueFamilyIndices = queueFamilies.data();
+  }
+
   if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
     throw std::runtime_error("failed to create image!");
   }
@@ -1343,20 +1958,19 @@ void AtomicVK::createImage(uint32_t width, uint32_t height, uint32_t mipLevels,
   VkMemoryRequirements memRequirements;
   vkGetImageMemoryRequirements(device, image, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+  imageMemory = allocator.allocate(memRequirements, findMemoryType(memRequirements.memoryTypeBits, properties), tiling == VK_IMAGE_TILING_LINEAR);
 
-  if (vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate image memory!");
-  }
+  vkBindImageMemory(device, image, imageMemory.memory, imageMemory.offset);
+}
 
-  vkBindImageMemory(device, image, imageMemory, 0);
+void AtomicVK::destroyImage(VkImage image, AtomicMemory::Allocation& imageMemory)
+{
+  vkDestroyImage(device, image, nullptr);
+  allocator.free(imageMemory);
 }
 
 void AtomicVK::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) {
-  VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+  VkCommandBuffer commandBuffer = setupCommands();
 
   VkImageMemoryBarrier barrier{};
   barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -1398,12 +2012,10 @@ void AtomicVK::transitionImageLayout(VkImage image, VkFormat format, VkImageLayo
           0, nullptr,
           1, &barrier
   );
-
-  endSingleTimeCommands(commandBuffer);
 }
 
 void AtomicVK::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
-  VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+  VkCommandBuffer commandBuffer = setupCommands();
 
   VkBufferImageCopy region{};
   region.bufferOffset = 0;
@@ -1421,41 +2033,109 @@ void AtomicVK::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width,
   };
 
   vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-  endSingleTimeCommands(commandBuffer);
 }
 
-VkCommandBuffer AtomicVK::beginSingleTimeCommands() {
-  VkCommandBufferAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandPool = commandPool;
-  allocInfo.commandBufferCount = 1;
+// Open (or continue) the setup batch; one-shot transfers record here instead of submitting on their own
+VkCommandBuffer AtomicVK::setupCommands()
+{
+  if (setupBatch.cmd) return setupBatch.cmd;
+
+  if (!setupFreeCmds.empty()) {
+    setupBatch.cmd = setupFreeCmds.back();
+    setupFreeCmds.pop_back();
+  } else {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = setupPool;
+    allocInfo.commandBufferCount = 1;
 
-  VkCommandBuffer commandBuffer;
-  vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+    if (vkAllocateCommandBuffers(device, &allocInfo, &setupBatch.cmd) != VK_SUCCESS) {
+      throw std::runtime_error("failed to allocate setup command buffer!");
+    }
+  }
 
   VkCommandBufferBeginInfo beginInfo{};
   beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+  vkBeginCommandBuffer(setupBatch.cmd, &beginInfo);
 
-  return commandBuffer;
+  return setupBatch.cmd;
 }
 
-void AtomicVK::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
-  vkEndCommandBuffer(commandBuffer);
+// Free a staging buffer once the batch that reads it has executed
+void AtomicVK::releaseAfterSetup(VkBuffer buffer, const AtomicMemory::Allocation& memory)
+{
+  setupBatch.staging.push_back({buffer, memory});
+}
+
+// Submit the setup batch; the returned fence stays valid until collectSetup() recycles it
+VkFence AtomicVK::flushSetup(bool wait)
+{
+  if (!setupBatch.cmd) return VK_NULL_HANDLE;
+
+  // Make transfer writes visible to every later use on this queue (vertex fetch, index fetch, sampling)
+  VkMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+  vkCmdPipelineBarrier(setupBatch.cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+  vkEndCommandBuffer(setupBatch.cmd);
+
+  if (!setupFreeFences.empty()) {
+    setupBatch.fence = setupFreeFences.back();
+    setupFreeFences.pop_back();
+  } else {
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateFence(device, &fenceInfo, nullptr, &setupBatch.fence) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create setup fence!");
+    }
+  }
 
   VkSubmitInfo submitInfo{};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
   submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer;
+  submitInfo.pCommandBuffers = &setupBatch.cmd;
+
+  if (vkQueueSubmit(graphics_queue, 1, &submitInfo, setupBatch.fence) != VK_SUCCESS) {
+    throw std::runtime_error("failed to submit setup commands!");
+  }
+
+  VkFence fence = setupBatch.fence;
+  setupInFlight.push_back(std::move(setupBatch));
+  setupBatch = SetupBatch();
+
+  if (wait) vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+  return fence;
+}
 
-  vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(graphics_queue);
+// Recycle finished batches: reset their command buffers and fences, free their staging buffers
+void AtomicVK::collectSetup(bool wait)
+{
+  while (!setupInFlight.empty())
+  {
+    SetupBatch &batch = setupInFlight.front();
+
+    if (wait) vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+    else if (vkGetFenceStatus(device, batch.fence) != VK_SUCCESS) break;
+
+    for (auto &staging : batch.staging)
+      destroyBuffer(staging.first, staging.second);
 
-  vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    vkResetCommandBuffer(batch.cmd, 0);
+    vkResetFences(device, 1, &batch.fence);
+    setupFreeCmds.push_back(batch.cmd);
+    setupFreeFences.push_back(batch.fence);
+
+    setupInFlight.erase(setupInFlight.begin());
+  }
 }
 
 VkImageView AtomicVK::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels) {
@@ -1501,94 +2181,6 @@ VkFormat AtomicVK::findDepthFormat() {
   );
 }
 
-void AtomicVK::generateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
-{
-  // Check if image format supports linear blitting
-  VkFormatProperties formatProperties;
-  vkGetPhysicalDeviceFormatProperties(physical_device, imageFormat, &formatProperties);
-
-  if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
-    throw std::runtime_error("texture image format does not support linear blitting!");
-  }
-
-  VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-  VkImageMemoryBarrier barrier{};
-  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-  barrier.image = image;
-  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  barrier.subresourceRange.baseArrayLayer = 0;
-  barrier.subresourceRange.layerCount = 1;
-  barrier.subresourceRange.levelCount = 1;
-
-  int32_t mipWidth = texWidth;
-  int32_t mipHeight = texHeight;
-
-  for (uint32_t i = 1; i < mipLevels; i++) {
-    barrier.subresourceRange.baseMipLevel = i - 1;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-    vkCmdPipelineBarrier(commandBuffer,
-                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
-                         0, nullptr,
-                         0, nullptr,
-                         1, &barrier);
-
-    VkImageBlit blit{};
-    blit.srcOffsets[0] = {0, 0, 0};
-    blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
-    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    blit.srcSubresource.mipLevel = i - 1;
-    blit.srcSubresource.baseArrayLayer = 0;
-    blit.srcSubresource.layerCount = 1;
-    blit.dstOffsets[0] = {0, 0, 0};
-    blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
-    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    blit.dstSubresource.mipLevel = i;
-    blit.dstSubresource.baseArrayLayer = 0;
-    blit.dstSubresource.layerCount = 1;
-
-    vkCmdBlitImage(commandBuffer,
-                   image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                   image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                   1, &blit,
-                   VK_FILTER_LINEAR);
-
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    vkCmdPipelineBarrier(commandBuffer,
-                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-                         0, nullptr,
-                         0, nullptr,
-                         1, &barrier);
-
-    if (mipWidth > 1) mipWidth /= 2;
-    if (mipHeight > 1) mipHeight /= 2;
-  }
-
-  barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-  vkCmdPipelineBarrier(commandBuffer,
-                       VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-                       0, nullptr,
-                       0, nullptr,
-                       1, &barrier);
-
-  endSingleTimeCommands(commandBuffer);
-}
-
 VkSampleCountFlagBits AtomicVK::getMaxUsableSampleCount()
 {
   VkPhysicalDeviceProperties physicalDeviceProperties;
@@ -1657,7 +2249,7 @@ VkExtent2D AtomicVK::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabiliti
   if (capabilities.currentExtent.width != UINT32_MAX)
     return capabilities.currentExtent;
 
-  VkExtent2D actual_extent = { w_width, w_height };
+  VkExtent2D actual_extent = { (uint32_t) framebuffer_width, (uint32_t) framebuffer_height };
   actual_extent.width = std::max(capabilities.minImageExtent.width, std::min(capabilities.maxImageExtent.width, actual_extent.width));
   actual_extent.height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, actual_extent.height));
 
@@ -1667,29 +2259,23 @@ VkExtent2D AtomicVK::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabiliti
 // Recreate SwapChain
 void AtomicVK::recreateSwapChain()
 {
-  int width=0, height=0;
-
-  glfwGetFramebufferSize(window, &width, &height);
-
-  while (!width || !height) {
-    glfwGetFramebufferSize(window, &width, &height);
-    glfwWaitEvents();
-  }
+  // Runs on the render thread, which may not pump GLFW: skip frames while minimized instead of waiting
+  swapchainStale = !framebuffer_width || !framebuffer_height;
+  if (swapchainStale) return;
 
   vkDeviceWaitIdle(device);
-  initVulkan(1);
+  cleanSwapChain();
+  initSwapChain();
 }
 
 // Destroy SwapChain
 void AtomicVK::cleanSwapChain()
 {
   vkDestroyImageView(device, depthImageView, nullptr);
-  vkDestroyImage(device, depthImage, nullptr);
-  vkFreeMemory(device, depthImageMemory, nullptr);
+  destroyImage(depthImage, depthImageMemory);
 
   vkDestroyImageView(device, colorImageView, nullptr);
-  vkDestroyImage(device, colorImage, nullptr);
-  vkFreeMemory(device, colorImageMemory, nullptr);
+  destroyImage(colorImage, colorImageMemory);
 
   for (auto framebuffer : swapChainFramebuffers) {
     vkDestroyFramebuffer(device, framebuffer, nullptr);
@@ -1697,21 +2283,12 @@ void AtomicVK::cleanSwapChain()
 
   vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
 
-  vkDestroyPipeline(device, graphicsPipeline, nullptr);
-  vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-  vkDestroyRenderPass(device, renderPass, nullptr);
-
   for (auto imageView : swapChainImageViews) {
     vkDestroyImageView(device, imageView, nullptr);
   }
 
   vkDestroySwapchainKHR(device, swapchain, nullptr);
 
-  for (size_t i = 0; i < swapchain_images.size(); i++) {
-    vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-    vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
-  }
-
   vkDestroyDescriptorPool(device, descriptorPool, nullptr);
 }
 
@@ -1731,21 +2308,6 @@ std::vector<char> AtomicVK::readFile(const std::string& filename)
   return buffer;
 }
 
-// Create a ShaderModule
-VkShaderModule AtomicVK::createShaderModule (const std::vector<char> &code)
-{
-  VkShaderModuleCreateInfo createInfo{};
-  createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-  createInfo.codeSize = code.size();
-  createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-
-  VkShaderModule shaderModule;
-  if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
-    throw std::runtime_error("failed to create shader module!");
-
-  return shaderModule;
-}
-
 // Find available memory type
 uint32_t AtomicVK::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 {
@@ -26,18 +26,37 @@
 #include <glm/mat4x4.hpp>
 #include <glm/gtx/hash.hpp>
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "AtomicVertex.h"
+#include "AtomicScene.h"
+#include "AtomicCull.h"
+#include "AtomicFrame.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "../vendor/stb_image.h"
 
+#define UNIFORM_RING_FRAME_SIZE     (64 << 10) // uniform bytes per frame in flight
+#define SECONDARY_BATCH_MIN_DRAWS   64         // indirect draws per secondary command buffer before splitting further
+#define PIPELINE_CACHE_FILE         "atomicengine.pipelinecache" // relative to the executable
+#define VERTEX_LAYOUT               AtomicVertex::Quantized // GPU vertex format: AtomicVertex::Float, Quantized or QuantizedNoNormal
+
 /** TEMP: .obj loader */
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "../vendor/tiny_obj_loader.h"
 
 class AtomicVK
 {
+  friend class AtomicUpload;
+
  public:
   float test_mip = 0.0,
         test_scale = 0.001;
+  unsigned test_instances = 1; // model copies laid out in a grid
+
+  unsigned frame_cap = 65;     // render rate, paced by AtomicEngine::scheduler (0: uncapped)
+  double interpolation = 1.0;  // [0,1) between the last two simulation steps
 
   AtomicEngine *engine;
   GLFWwindow *window;
@@ -45,6 +64,7 @@ class AtomicVK
 
   AtomicVK (AtomicEngine *e) : engine(e)
   {
+    initTimers();
     initScreen();
     initVulkan();
 
@@ -53,59 +73,60 @@ class AtomicVK
   }
 
   void reload();
+  void simulate(double dt);
   void exit();
   void callback();
 
+  AtomicTimer::Handle fps_timer, title_timer, shader_timer;
+  std::atomic<uint64_t> draw_ns{0}; // CPU time of the last draw()
+  std::atomic<uint32_t> visible_instances{0}; // instances that survived culling in the last draw()
+  void initTimers();
+
+  // Render thread: draws the newest packet published by callback(); gpu_mutex serializes other GPU work against it
+  void startRenderThread();
+  void stopRenderThread();
+
+  // Source vertex: what the OBJ loader and mesh cache produce and the welder keys on; encoded into GPUVertex for the vertex buffer
   struct Vertex {
     glm::vec3 pos;
-    glm::vec3 color;
+    glm::vec3 normal;
     glm::vec2 texCoord;
 
-    static VkVertexInputBindingDescription getBindingDescription() {
-      VkVertexInputBindingDescription bindingDescription{};
-      bindingDescription.binding = 0;
-      bindingDescription.stride = sizeof(Vertex);
-      bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-      return bindingDescription;
-    }
-
-    static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
-      std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
-
-      attributeDescriptions[0].binding = 0;
-      attributeDescriptions[0].location = 0;
-      attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-      attributeDescriptions[0].offset = offsetof(Vertex, pos);
-
-      attributeDescriptions[1].binding = 0;
-      attributeDescriptions[1].location = 1;
-      attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-      attributeDescriptions[1].offset = offsetof(Vertex, color);
-
-      attributeDescriptions[2].binding = 0;
-      attributeDescriptions[2].location = 2;
-      attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-      attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
-
-      return attributeDescriptions;
-    }
-
     bool operator==(const Vertex& other) const {
-      return pos == other.pos && color == other.color && texCoord == other.texCoord;
+      return pos == other.pos && normal == other.normal && texCoord == other.texCoord;
     }
   };
 
+  typedef VERTEX_LAYOUT GPUVertex;
+
   // Misc
   static std::vector<char> readFile(const std::string& filename);
+  static Vertex objVertex(const tinyobj::attrib_t &attrib, const AtomicMesh::ObjIndex &index);
 
  protected:
 
-  void draw();
+  void draw(const AtomicFrame &frame);
+  void publishFrame();
+  void renderLoop();
 
-  // Initialize Vulkan
-  void initVulkan(bool recreate=0);
+  AtomicTripleBuffer<AtomicFrame> frames;
+  std::thread render_thread;                                std::exception_ptr render_error;
+  std::mutex gpu_mutex, frame_mutex;                        std::condition_variable frame_cv;
+  bool render_running = false;                              std::atomic<bool> render_failed{false};
+
+  // Initialize Vulkan: device, swapchain and asset lifetimes
+  void initVulkan();
+  void initSwapChain();
+  void initAssets(bool reload=false);
   void destroyVulkan();
+
+  void createRenderPass();
+  void createGraphicsPipeline();
+  VkPipeline buildGraphicsPipeline();
+  void reloadShaders();
+
+  void loadPipelineCache();
+  void savePipelineCache();
   // Screen
   void initScreen();
   void destroyScreen();
@@ -122,21 +143,30 @@ class AtomicVK
 
   bool checkDeviceExtensionSupport(VkPhysicalDevice device);
 
-  void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+  void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, AtomicMemory::Allocation& bufferMemory);
+
+  void destroyBuffer(VkBuffer buffer, AtomicMemory::Allocation& bufferMemory);
 
   void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 
-  void updateUniformBuffer(uint32_t currentImage);
+  uint32_t updateUniformBuffer(const AtomicFrame &frame);
+  glm::mat4 projection(const AtomicFrame &frame) const;
+
+  VkDeviceSize uniformAlloc(VkDeviceSize size);
 
-  void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+  void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, AtomicMemory::Allocation& imageMemory, const std::vector<uint32_t>& queueFamilies = {});
+
+  void destroyImage(VkImage image, AtomicMemory::Allocation& imageMemory);
 
   void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels);
 
   void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
 
-  VkCommandBuffer beginSingleTimeCommands();
-
-  void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+  // Batched one-shot commands
+  VkCommandBuffer setupCommands();
+  void releaseAfterSetup(VkBuffer buffer, const AtomicMemory::Allocation& memory);
+  VkFence flushSetup(bool wait=false);
+  void collectSetup(bool wait=false);
 
   VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
 
@@ -144,7 +174,19 @@ class AtomicVK
 
   VkFormat findDepthFormat();
 
-  void generateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
+  void recordCommandBuffer(uint32_t i, const AtomicFrame &frame);
+
+  // Per-frame secondary recording: [frame in flight * secondaryBatches + batch]
+  struct SecondaryPool { VkCommandPool pool = VK_NULL_HANDLE; VkCommandBuffer cmd = VK_NULL_HANDLE; };
+  std::vector<SecondaryPool> secondaryPools;                uint32_t secondaryBatches = 1;
+  std::vector<VkCommandBuffer> secondaryCmds;
+  void recordSecondary(uint32_t i, size_t begin, size_t end, const uint32_t *dynamicOffsets, SecondaryPool &secondary);
+
+  void updateDescriptorSet(uint32_t i);
+
+  uint32_t addTexture(const std::string &path);
+  void onTextureUploaded(uint32_t id, const AtomicUpload::Texture &texture);
+  void destroyRetiredTextures(uint64_t frame = UINT64_MAX);
 
   VkSampleCountFlagBits getMaxUsableSampleCount();
 
@@ -161,6 +203,8 @@ class AtomicVK
   VkPhysicalDeviceFeatures deviceFeatures {};               float queuePriority = 1.0f;
   VkDevice device;                                          VkQueue graphics_queue;
   VkSurfaceKHR surface;                                     VkQueue present_queue;
+  VkQueue transfer_queue;                                   AtomicUpload upload;
+  AtomicMemory allocator;                                   AtomicShader shaders;
 
   VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& available_formats);
   VkPresentModeKHR chooseSwapPresentationMode(const std::vector<VkPresentModeKHR>& available_presentation_modes);
@@ -177,38 +221,76 @@ class AtomicVK
   std::vector<VkImageView> swapChainImageViews;
   void recreateSwapChain(); void cleanSwapChain();
 
-  VkShaderModule createShaderModule(const std::vector<char>& code);
-
   std::vector<VkFramebuffer> swapChainFramebuffers;
   VkCommandPool commandPool;                                std::vector<VkCommandBuffer> commandBuffers;
 
+  // Setup batches: recorded together, submitted once, recycled when their fence signals
+  struct SetupBatch { VkCommandBuffer cmd = VK_NULL_HANDLE; VkFence fence = VK_NULL_HANDLE; std::vector<std::pair<VkBuffer, AtomicMemory::Allocation>> staging; };
+  VkCommandPool setupPool;                                  SetupBatch setupBatch;
+  std::vector<SetupBatch> setupInFlight;                    std::vector<VkCommandBuffer> setupFreeCmds;
+  std::vector<VkFence> setupFreeFences;
+
   VkRenderPass renderPass;                                  VkPipeline graphicsPipeline;
+  VkPipelineCache pipelineCache = VK_NULL_HANDLE;           bool pipelineCacheWarm = false;
   VkDescriptorSetLayout descriptorSetLayout;                VkPipelineLayout pipelineLayout;
 
+  // Pipelines and the shaders they are built from, for hot-reload
+  struct PipelineSource { VkPipeline *pipeline; std::vector<std::string> shaders; VkPipeline (AtomicVK::*build)(); };
+  std::vector<PipelineSource> pipelineSources;
+
   const int MAX_FRAMES_IN_FLIGHT = 2;
   std::vector<VkSemaphore> imageAvailableSemaphores;        std::vector<VkSemaphore> renderFinishedSemaphores;
   std::vector<VkFence> inFlightFences;                      std::vector<VkFence> imagesInFlight;
-  size_t currentFrame = 0;                                  bool framebufferResized = false;
-
-  VkBuffer vertexBuffer;                                    VkDeviceMemory vertexBufferMemory;
-  VkBuffer indexBuffer;                                     VkDeviceMemory indexBufferMemory;
-
-  std::vector<uint32_t> indices;                            std::vector<VkBuffer> uniformBuffers;
-  std::vector<Vertex> vertices;                             std::vector<VkDeviceMemory> uniformBuffersMemory;
+  size_t currentFrame = 0;                                  std::atomic<bool> framebufferResized{false};
+  std::atomic<int> framebuffer_width{0}, framebuffer_height{0}; bool swapchainStale = false;
+  static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+
+  VkBuffer vertexBuffer;                                    AtomicMemory::Allocation vertexBufferMemory;
+  VkBuffer indexBuffer;                                     AtomicMemory::Allocation indexBufferMemory;
+
+  std::vector<uint32_t> indices;                            VkBuffer uniformRing;
+  std::vector<Vertex> vertices;                             AtomicMemory::Allocation uniformRingMemory;
+  VkDeviceSize uniformAlignment = 256;                      std::atomic<VkDeviceSize> uniformCursor{0};
+  AtomicMesh mesh;                                          AtomicScene scene; // mesh ranges of the bound vertex/index buffers
+  glm::vec3 meshMin{0.0f}, meshMax{0.0f};                   AtomicVertex::Quantization meshQuantization; // loaded model's local bounds
+
+  // Per frame in flight: instance records (storage, dynamic offset) and the indirect commands drawing them
+  VkBuffer instanceRing;                                    AtomicMemory::Allocation instanceRingMemory;
+  VkBuffer indirectRing;                                    AtomicMemory::Allocation indirectRingMemory;
+  VkBuffer meshBuffer;                                      AtomicMemory::Allocation meshBufferMemory; // AtomicScene::MeshData per mesh, rewritten by initAssets
+  std::vector<VkDrawIndexedIndirectCommand> indirectCommands;
+  AtomicCull cull;                                          std::vector<uint32_t> visibleInstances; // world bounds of this frame's instances, survivors
+  bool multiDrawIndirect = false;                           bool indirectFirstInstance = false;
+  bool textureCompressionBC = false;
+  float model_angle = 0.0f;                                 float model_angle_prev = 0.0f;
+
+  VkDescriptorPool descriptorPool;                          VkImage depthImage;
+  std::vector<VkDescriptorSet> descriptorSets;              VkFormat depthFormat;
+
+  AtomicMemory::Allocation depthImageMemory;                VkImage colorImage;
+  VkImageView depthImageView;                               AtomicMemory::Allocation colorImageMemory;
+  VkImageView colorImageView;
+  VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
 
-  VkDescriptorPool descriptorPool;                          VkDeviceMemory textureImageMemory;
-  std::vector<VkDescriptorSet> descriptorSets;              VkImageView textureImageView;
-  VkImage textureImage;                                     VkImage depthImage;
-  VkSampler textureSampler;                                 VkFormat depthFormat;
+  // Bindless textures (set 1): [AtomicResidency id] -> image and slot; unloaded ids sample the placeholder's slot
+  struct BoundTexture
+  {
+    VkImage image = VK_NULL_HANDLE;         AtomicMemory::Allocation memory;
+    VkImageView view = VK_NULL_HANDLE;      uint32_t mipLevels = 1;
+    uint32_t slot = 0;                      uint32_t sampler = AtomicBindless::LinearRepeat;
+  };
+  AtomicBindless bindless;                                  BoundTexture placeholder;
+  std::vector<BoundTexture> textures;                       std::vector<AtomicScene::Material> materials;
+  uint64_t frameNumber = 0;                                 // frames submitted; slots and images retire by it
 
-  VkDeviceMemory depthImageMemory;                          VkImage colorImage;
-  VkImageView depthImageView;                               VkDeviceMemory colorImageMemory;
-  VkImageView colorImageView;                               uint32_t mipLevels;
-  VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+  // Streamed textures: a replaced image (and its slot) retires once the frames before `frame` are done
+  struct RetiredTexture { VkImage image; AtomicMemory::Allocation memory; VkImageView view; uint64_t frame; };
+  std::vector<RetiredTexture> retiredTextures;
+  AtomicResidency residency;                                std::vector<AtomicResidency::Request> residencyRequests;
+  uint32_t streamedTexture = ~0u;                           uint64_t residencyTime = 0; // test model's texture, last update (ns)
+  void updateResidency(const AtomicFrame &frame, size_t visible);
 
   struct UniformBufferObject {
-    alignas(16) glm::mat4 model2;
-    alignas(16) glm::mat4 model;
     alignas(16) glm::mat4 view;
     alignas(16) glm::mat4 proj;
   };
@@ -220,7 +302,7 @@ class AtomicVK
 
 template<> struct std::hash<AtomicVK::Vertex> {
   size_t operator()(AtomicVK::Vertex const& vertex) const {
-    return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
+    return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.normal) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
   }
 };
 
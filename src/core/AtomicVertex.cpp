@@ -0,0 +1,87 @@
+/**
+ * AtomicVertex 0.1
+ */
+
+AtomicVertex::Quantization AtomicVertex::Quantization::bounds(const glm::vec3 &min, const glm::vec3 &max)
+{
+  // Flat axes keep a non-zero scale, so every stored value decodes to the plane itself
+  Quantization q;
+  q.offset = (min + max) * 0.5f;
+  q.scale = glm::max((max - min) * 0.5f, glm::vec3(1e-20f));
+  return q;
+}
+
+void AtomicVertex::Float::encode(const glm::vec3 &pos, const glm::vec3 &normal, const glm::vec2 &texCoord, const Quantization &, Float &out)
+{
+  out.pos = {{pos.x, pos.y, pos.z}};
+  out.normal = {{normal.x, normal.y, normal.z}};
+  out.texCoord = {{texCoord.x, texCoord.y}};
+}
+
+void AtomicVertex::Quantized::encode(const glm::vec3 &pos, const glm::vec3 &normal, const glm::vec2 &texCoord, const Quantization &q, Quantized &out)
+{
+  glm::vec3 p = (pos - q.offset) / q.scale;
+  glm::vec2 n = octahedral(normal);
+
+  out.pos = {{snorm16(p.x), snorm16(p.y), snorm16(p.z), 0}};
+  out.normal = {{snorm16(n.x), snorm16(n.y)}};
+  out.texCoord = {{half(texCoord.x), half(texCoord.y)}};
+}
+
+void AtomicVertex::QuantizedNoNormal::encode(const glm::vec3 &pos, const glm::vec3 &, const glm::vec2 &texCoord, const Quantization &q, QuantizedNoNormal &out)
+{
+  glm::vec3 p = (pos - q.offset) / q.scale;
+
+  out.pos = {{snorm16(p.x), snorm16(p.y), snorm16(p.z), 0}};
+  out.texCoord = {{half(texCoord.x), half(texCoord.y)}};
+}
+
+int16_t AtomicVertex::snorm16(float v)
+{
+  return (int16_t) std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f);
+}
+
+// IEEE binary16, round to nearest even; overflow goes to infinity, NaN stays NaN
+uint16_t AtomicVertex::half(float v)
+{
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+
+  uint32_t sign = (bits >> 16) & 0x8000, exponent = (bits >> 23) & 0xFF, mantissa = bits & 0x7FFFFF;
+
+  if (exponent == 0xFF) return (uint16_t) (sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+  int32_t e = (int32_t) exponent - 127 + 15;
+  if (e >= 0x1F) return (uint16_t) (sign | 0x7C00);
+
+  // Subnormal (or zero) in half: shift the implicit bit in, then round what falls off
+  if (e <= 0)
+  {
+    if (e < -10) return (uint16_t) sign;
+
+    mantissa |= 0x800000;
+    uint32_t shift = (uint32_t) (14 - e), value = mantissa >> shift, rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (value & 1))) value++;
+    return (uint16_t) (sign | value);
+  }
+
+  // Normal: a carry out of the mantissa bumps the exponent, which is exactly right (up to infinity)
+  uint32_t value = ((uint32_t) e << 10) | (mantissa >> 13), rest = mantissa & 0x1FFF;
+  if (rest > 0x1000 || (rest == 0x1000 && (value & 1))) value++;
+  return (uint16_t) (sign | value);
+}
+
+glm::vec2 AtomicVertex::octahedral(const glm::vec3 &normal)
+{
+  float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  if (l1 <= 0.0f) return glm::vec2(0.0f);  // no normal: +Z
+
+  glm::vec2 p = glm::vec2(normal.x, normal.y) / l1;
+
+  // Lower hemisphere folds over the diagonals
+  if (normal.z < 0.0f)
+    p = glm::vec2((1.0f - std::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+                  (1.0f - std::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f));
+
+  return p;
+}
@@ -0,0 +1,113 @@
+/**
+ * AtomicVertex 0.1
+ *
+ * GPU vertex layouts. A layout is a struct of attribute types, each of which knows
+ * the VkFormat the input assembler reads it as; Layout<...> turns the list into
+ * binding and attribute descriptions (location = declaration order) at compile
+ * time. Meshes are loaded and welded as float vertices and encoded into the
+ * selected layout on the way to the GPU: positions as 16-bit snorm inside the
+ * mesh bounds (undone by a per-mesh scale and offset), normals octahedral, UVs half.
+ */
+
+#ifndef ATOMICVERTEX_H
+#define ATOMICVERTEX_H
+
+#include <vulkan/vulkan.h>
+
+#define VERTEX_ENCODE_GRAIN         4096 // vertices per encode job
+
+class AtomicVertex
+{
+ public:
+  // Attribute storage: member layout plus the format it is fetched as
+  struct Float3    { float v[3];    static constexpr VkFormat format = VK_FORMAT_R32G32B32_SFLOAT; };
+  struct Float2    { float v[2];    static constexpr VkFormat format = VK_FORMAT_R32G32_SFLOAT; };
+  struct Snorm16x4 { int16_t v[4];  static constexpr VkFormat format = VK_FORMAT_R16G16B16A16_SNORM; };  // 3-component snorm16 is rarely a vertex format
+  struct Snorm16x2 { int16_t v[2];  static constexpr VkFormat format = VK_FORMAT_R16G16_SNORM; };
+  struct Half2     { uint16_t v[2]; static constexpr VkFormat format = VK_FORMAT_R16G16_SFLOAT; };
+
+  // Per-mesh position transform: stored = (position - offset) / scale; the vertex shader does stored * scale + offset
+  struct Quantization
+  {
+    glm::vec3 scale = glm::vec3(1.0f), offset = glm::vec3(0.0f);
+
+    static Quantization bounds(const glm::vec3 &min, const glm::vec3 &max);  // [min, max] onto [-1, 1] per axis
+  };
+
+  // Binding and attribute descriptions for a vertex whose members are Attributes..., in order
+  template<typename... Attributes> struct Layout
+  {
+    static constexpr uint32_t count = sizeof...(Attributes);
+    static constexpr uint32_t stride = (sizeof(Attributes) + ...);
+
+    static constexpr std::array<uint32_t, count> offsets()
+    {
+      std::array<uint32_t, count> offset{};
+      uint32_t sizes[] = {(uint32_t) sizeof(Attributes)...};
+      for (uint32_t i = 1; i < count; i++) offset[i] = offset[i - 1] + sizes[i - 1];
+      return offset;
+    }
+
+    static constexpr VkVertexInputBindingDescription binding(uint32_t binding = 0)
+    {
+      return {binding, stride, VK_VERTEX_INPUT_RATE_VERTEX};
+    }
+
+    static constexpr std::array<VkVertexInputAttributeDescription, count> attributes(uint32_t binding = 0)
+    {
+      std::array<VkVertexInputAttributeDescription, count> attributes{};
+      VkFormat formats[] = {Attributes::format...};
+      std::array<uint32_t, count> offset = offsets();
+      for (uint32_t i = 0; i < count; i++) attributes[i] = {i, binding, formats[i], offset[i]};
+      return attributes;
+    }
+  };
+
+  // 32 bytes: the float source as is
+  struct Float : Layout<Float3, Float3, Float2>
+  {
+    Float3 pos, normal; Float2 texCoord;
+
+    static constexpr bool quantized = false;
+    static std::vector<std::string> defines() { return {}; }
+    static void encode(const glm::vec3 &pos, const glm::vec3 &normal, const glm::vec2 &texCoord, const Quantization &q, Float &out);
+  };
+
+  // 16 bytes: snorm16 position (w unused), octahedral snorm16 normal, half UV
+  struct Quantized : Layout<Snorm16x4, Snorm16x2, Half2>
+  {
+    Snorm16x4 pos; Snorm16x2 normal; Half2 texCoord;
+
+    static constexpr bool quantized = true;
+    static std::vector<std::string> defines() { return {"VERTEX_OCTAHEDRAL_NORMAL"}; }
+    static void encode(const glm::vec3 &pos, const glm::vec3 &normal, const glm::vec2 &texCoord, const Quantization &q, Quantized &out);
+  };
+
+  // 12 bytes: snorm16 position, half UV; for meshes that are never lit
+  struct QuantizedNoNormal : Layout<Snorm16x4, Half2>
+  {
+    Snorm16x4 pos; Half2 texCoord;
+
+    static constexpr bool quantized = true;
+    static std::vector<std::string> defines() { return {"VERTEX_NO_NORMAL"}; }
+    static void encode(const glm::vec3 &pos, const glm::vec3 &normal, const glm::vec2 &texCoord, const Quantization &q, QuantizedNoNormal &out);
+  };
+
+  // Quantization for a mesh with these local bounds; identity for float layouts
+  template<typename V> static Quantization quantization(const glm::vec3 &min, const glm::vec3 &max)
+  {
+    return V::quantized ? Quantization::bounds(min, max) : Quantization();
+  }
+
+  // Scalar encoders (round to nearest; snorm as Vulkan decodes it: max(c / 32767, -1))
+  static int16_t snorm16(float v);
+  static uint16_t half(float v);
+  static glm::vec2 octahedral(const glm::vec3 &normal);  // unit vector onto the [-1, 1]^2 octahedron map
+};
+
+// Members must sit where the generated descriptions say they do
+static_assert(sizeof(AtomicVertex::Float) == AtomicVertex::Float::stride && offsetof(AtomicVertex::Float, normal) == AtomicVertex::Float::offsets()[1] && offsetof(AtomicVertex::Float, texCoord) == AtomicVertex::Float::offsets()[2]);
+static_assert(sizeof(AtomicVertex::Quantized) == AtomicVertex::Quantized::stride && offsetof(AtomicVertex::Quantized, normal) == AtomicVertex::Quantized::offsets()[1] && offsetof(AtomicVertex::Quantized, texCoord) == AtomicVertex::Quantized::offsets()[2]);
+static_assert(sizeof(AtomicVertex::QuantizedNoNormal) == AtomicVertex::QuantizedNoNormal::stride && offsetof(AtomicVertex::QuantizedNoNormal, texCoord) == AtomicVertex::QuantizedNoNormal::offsets()[1]);
+
+#endif //ATOMICVERTEX_H
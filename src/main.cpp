@@ -9,8 +9,7 @@
  * Recommended audio library: FMOD
  * Learn Spir-V: https://www.duskborn.com/wp-content/uploads/2015/03/AnIntroductionToSPIR-V.pdf , https://www.khronos.org/registry/spir-v/specs/1.0/SPIRV.pdf
  *
- * Compile to SPIR-V: glslangValidator -e main -o shaders/spirv/shader.frag.spv -V shaders/shader.frag.glsl  &&
- *                    glslangValidator -e main -o shaders/spirv/shader.vert.spv -V shaders/shader.vert.glsl
+ * Shaders compile at runtime with libshaderc (cached per define set in <exe dir>/shadercache).
  *
  * Build EMC: emcc -o build/main.html main.cpp -O3 -s WASM=1 --shell-file build/shell.html
  */
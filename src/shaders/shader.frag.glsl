@@ -1,13 +1,22 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : require
 
-layout(binding = 1) uniform sampler2D texSampler;
+// Set 1 (AtomicBindless): every resident texture, and the shared samplers (AtomicBindless::SamplerCount)
+layout(set = 1, binding = 0) uniform texture2D textures[];
+layout(set = 1, binding = 1) uniform sampler samplers[3];
 
-layout(location = 0) in vec3 fragColor;
+layout(location = 0) in vec3 fragNormal;
 layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in uvec2 fragMaterial; // x: texture slot, y: sampler
+layout(location = 3) flat in float fragMinLod;   // clamps sampling to the levels that are resident and faded in
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
+    // Instances of one draw may use different textures: the index is not uniform across the subgroup
+    #define TEXTURE sampler2D(textures[nonuniformEXT(fragMaterial.x)], samplers[nonuniformEXT(fragMaterial.y)])
+
+    float lod = max(textureQueryLod(TEXTURE, fragTexCoord).y, fragMinLod);
+    outColor = textureLod(TEXTURE, fragTexCoord, lod);
 }
\ No newline at end of file
@@ -1,30 +1,82 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// One dynamic slice per frame: UniformBufferObject, then UniformBufferCamera
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model2;
-    mat4 model;
     mat4 view;
     mat4 proj;
+    mat4 cameraView;
 } ubo;
 
-layout(binding = 0) uniform UniformBufferCamera {
-    mat4 view;
-} camera;
+// AtomicScene::InstanceData: transform, bindless texture slot and sampler, LOD clamp, mesh
+struct Instance {
+    mat4 model;
+    uint textureIndex;
+    uint samplerIndex;
+    float minLod;
+    uint meshIndex;
+};
+
+// This frame's instance records, bucketed by mesh; gl_InstanceIndex includes the command's firstInstance
+layout(std430, binding = 2) readonly buffer InstanceBuffer {
+    Instance instances[];
+};
+
+// AtomicScene::MeshData: stored positions -> local (identity for float vertices)
+struct Mesh {
+    vec4 scale;
+    vec4 offset;
+};
+
+layout(std430, binding = 3) readonly buffer MeshBuffer {
+    Mesh meshes[];
+};
 
+// AtomicVertex layout (VERTEX_LAYOUT): locations follow its members; snorm and half formats arrive as floats
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
+#if defined(VERTEX_NO_NORMAL)
+layout(location = 1) in vec2 inTexCoord;
+#elif defined(VERTEX_OCTAHEDRAL_NORMAL)
+layout(location = 1) in vec2 inNormal;
 layout(location = 2) in vec2 inTexCoord;
+#else
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+#endif
 
-layout(location = 0) out vec3 fragColor;
+layout(location = 0) out vec3 fragNormal;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out uvec2 fragMaterial;
+layout(location = 3) flat out float fragMinLod;
+
+vec3 octahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
 
 void main()
 {
     mat4 viewmake = mat4(ubo.view);
-         //viewmake[0].x = camera.view[0].x;
+         //viewmake[0].x = ubo.cameraView[0].x;
+
+    Instance instance = instances[gl_InstanceIndex];
+    Mesh mesh = meshes[instance.meshIndex];
+    vec3 position = inPosition * mesh.scale.xyz + mesh.offset.xyz;
+
+#if defined(VERTEX_NO_NORMAL)
+    vec3 normal = vec3(0.0, 0.0, 1.0);
+#elif defined(VERTEX_OCTAHEDRAL_NORMAL)
+    vec3 normal = octahedralDecode(inNormal);
+#else
+    vec3 normal = inNormal;
+#endif
 
-    gl_Position = ubo.proj * viewmake * ubo.model * vec4(inPosition, 1.0);
-    fragColor = inColor;
+    gl_Position = ubo.proj * viewmake * instance.model * vec4(position, 1.0);
+    fragNormal = mat3(instance.model) * normal;
     fragTexCoord = inTexCoord;
+    fragMaterial = uvec2(instance.textureIndex, instance.samplerIndex);
+    fragMinLod = instance.minLod;
 }
\ No newline at end of file